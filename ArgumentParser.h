@@ -2,15 +2,23 @@
 #define ARANGODB_PROGRAM_OPTIONS_ARGUMENT_PARSER_H 1
 
 #include <string>
+#include <memory>
+#include <vector>
 
 #include "ProgramOptions.h"
+#include "ResponseFile.h"
+#include "Token.h"
 
 namespace arangodb {
 namespace options {
 
 class ArgumentParser {
  public:
-  explicit ArgumentParser(ProgramOptions* options) : _options(options) {}
+  explicit ArgumentParser(ProgramOptions* options)
+      : _options(options), _responseFiles(false) {}
+
+  // enable or disable expansion of response files ("@<file>" arguments)
+  void allowResponseFiles(bool value) { _responseFiles = value; }
 
   // get the name of the section for which help was requested, and "*" if only
   // --help was specified
@@ -27,83 +35,249 @@ class ArgumentParser {
     return "";
   }
 
-  // parse options from argc/argv. returns true if all is well, false otherwise
-  // errors that occur during parse are reported to _options
-  bool parse(int argc, char* argv[]) {
-    // set context for parsing (used in error messages)
-    _options->setContext("command-line options");
-
-    std::string lastOption;
-
+  // get the search terms if help for matching options was requested via
+  // "--help-search <terms>" or "--help-search=<terms>". the terms are all
+  // following arguments up to the next option. returns an empty string if
+  // no search was requested
+  std::string helpSearch(int argc, char* argv[]) {
     for (int i = 1; i < argc; ++i) {
-      std::string option;
-      std::string value;
       std::string const current(argv[i]);
+      if (current.compare(0, 14, "--help-search=") == 0) {
+        return current.substr(14);
+      }
+      if (current == "--help-search") {
+        std::string terms;
+        while (++i < argc && argv[i][0] != '-') {
+          if (!terms.empty()) {
+            terms.push_back(' ');
+          }
+          terms.append(argv[i]);
+        }
+        return terms;
+      }
+    }
+    return "";
+  }
+
+  // lazy token stream over argc/argv. each call to next() resolves the next
+  // option (or positional argument) without applying it
+  // if response files are enabled, an argument "@<file>" is replaced by the
+  // arguments read from the file. response files can be nested
+  class Tokenizer {
+   public:
+    Tokenizer(ProgramOptions* options, int argc, char* argv[],
+              bool responseFiles = false)
+        : _options(options),
+          _argc(argc),
+          _argv(argv),
+          _index(1),
+          _responseFiles(responseFiles),
+          _done(false) {}
+
+    // produce the next token. returns false if there are no more tokens
+    bool next(Token& token) {
+      if (_done) {
+        return false;
+      }
 
-      if (!lastOption.empty()) {
-        option = lastOption;
+      token.option.clear();
+      token.value.clear();
+
+      switch (nextArgument(_current, token.location)) {
+        case ResponseFile::Result::End:
+          _done = true;
+          return false;
+        case ResponseFile::Result::Error:
+          return error(token, _current);
+        case ResponseFile::Result::Argument:
+          break;
       }
 
-      if (!option.empty()) {
-        value = current;
-      } else {
-        option = current;
+      std::string const& current = _current;
+
+      size_t dashes = 0;
+      if (current.compare(0, 2, "--") == 0) {
+        dashes = 2;
+      } else if (current.compare(0, 1, "-") == 0) {
+        dashes = 1;
+      }
+
+      if (dashes == 0) {
+        token.type = Token::Type::Positional;
+        token.value = current;
+        return true;
+      }
 
-        size_t dashes = 0;
-        if (option.substr(0, 2) == "--") {
-          dashes = 2;
-        } else if (option.substr(0, 1) == "-") {
-          dashes = 1;
+      token.type = Token::Type::Option;
+      token.option = current.substr(dashes);
+
+      size_t const pos = token.option.find('=');
+
+      if (pos != std::string::npos) {
+        // option = value
+        token.value = token.option.substr(pos + 1);
+        token.option.resize(pos);
+        if (dashes == 1) {
+          token.option = _options->translateShorthand(token.option);
         }
+        return true;
+      }
 
-        if (dashes == 0) {
-          _options->addPositional(option);
-          continue;
+      // only option
+      if (dashes == 1) {
+        token.option = _options->translateShorthand(token.option);
+      }
+
+      if (!_options->hasOption(token.option)) {
+        token.type = Token::Type::Unknown;
+        return true;
+      }
+
+      if (_options->requiresValue(token.option)) {
+        // option requires a parameter, which is the next argument
+        SourceLocation location;
+        switch (nextArgument(token.value, location)) {
+          case ResponseFile::Result::End:
+            // we got an option, but no value was specified for it
+            return error(token,
+                         "no value specified for option '" + token.option + "'");
+          case ResponseFile::Result::Error:
+            token.location = location;
+            return error(token, token.value);
+          case ResponseFile::Result::Argument:
+            break;
         }
+      }
 
-        option = option.substr(dashes);
+      return true;
+    }
 
-        size_t const pos = option.find('=');
+   private:
+    // turn the token into an error token. no more tokens are produced
+    bool error(Token& token, std::string const& message) {
+      token.type = Token::Type::Error;
+      token.value = message;
+      _done = true;
+      return true;
+    }
 
-        if (pos == std::string::npos) {
-          // only option
-          if (dashes == 1) {
-            option = _options->translateShorthand(option);
+    // get the next argument, from argv or from the current response file,
+    // and its location. on error, argument contains the error message
+    ResponseFile::Result nextArgument(std::string& argument,
+                                      SourceLocation& location) {
+      while (true) {
+        if (!_files.empty()) {
+          ResponseFile& file = *_files.back();
+          ResponseFile::Result const result = file.next(argument);
+          location.type = SourceType::ResponseFile;
+          location.name = file.name();
+          location.position = file.line();
+          if (result == ResponseFile::Result::End) {
+            _files.pop_back();
+            continue;
           }
-          if (!_options->require(option)) {
-            return false;
+          if (result == ResponseFile::Result::Error) {
+            return result;
           }
-
-          if (!_options->requiresValue(option)) {
-            // option does not require a parameter
-            if (!_options->setValue(option, "")) {
-              return false;
-            }
-          } else {
-            // option requires a parameter
-            lastOption = option;
-          }
-          continue;
         } else {
-          // option = value
-          value = option.substr(pos + 1);
-          option = option.substr(0, pos);
-          if (dashes == 1) {
-            option = _options->translateShorthand(option);
+          if (_index >= _argc) {
+            return ResponseFile::Result::End;
           }
+          location.type = SourceType::CommandLine;
+          location.name.clear();
+          location.position = static_cast<size_t>(_index);
+          argument = _argv[_index++];
+        }
+
+        if (!_responseFiles || argument.size() < 2 || argument[0] != '@') {
+          return ResponseFile::Result::Argument;
+        }
+
+        // open response file and continue with its arguments
+        if (!open(argument.substr(1), argument)) {
+          return ResponseFile::Result::Error;
         }
       }
+    }
+
+    // open a response file. on error, message contains the error message
+    bool open(std::string const& name, std::string& message) {
+      std::string const resolved = ResponseFile::resolve(
+          name, _files.empty() ? nullptr : _files.back().get());
+      std::string const path = ResponseFile::canonicalPath(resolved);
 
-      if (!_options->setValue(option, value)) {
+      for (auto const& it : _files) {
+        if (!path.empty() && it->path() == path) {
+          message = "recursive inclusion of response file '" + resolved + "'";
+          return false;
+        }
+      }
+
+      std::unique_ptr<ResponseFile> file(new ResponseFile(resolved, path));
+      if (!file->isOpen()) {
+        message = "unable to open response file '" + resolved + "'";
         return false;
       }
-      lastOption = "";
+
+      _files.emplace_back(std::move(file));
+      return true;
     }
 
-    // we got some previous option, but no value was specified for it
-    if (!lastOption.empty()) {
-      return _options->fail("no value specified for option '" + lastOption +
-                            "'");
+    ProgramOptions* _options;
+    int const _argc;
+    char** _argv;
+    // index of the next argument in argv
+    int _index;
+    // whether or not "@<file>" arguments are expanded
+    bool const _responseFiles;
+    // whether or not the end of the token stream was reached
+    bool _done;
+    // the argument currently being tokenized
+    std::string _current;
+    // stack of open response files, innermost last
+    std::vector<std::unique_ptr<ResponseFile>> _files;
+  };
+
+  // create a lazy token stream over argc/argv
+  Tokenizer tokenize(int argc, char* argv[]) const {
+    return Tokenizer(_options, argc, argv, _responseFiles);
+  }
+
+  // parse options from argc/argv. returns true if all is well, false otherwise
+  // errors that occur during parse are reported to _options
+  bool parse(int argc, char* argv[]) {
+    Tokenizer tokenizer(_options, argc, argv, _responseFiles);
+    Token token;
+
+    if (_options->validationConcurrency() > 1) {
+      // apply the tokens in batches, so that their values can be validated
+      // concurrently. positional arguments end a batch and are applied
+      // right away, so that the positional handler still receives them
+      // while the arguments are tokenized
+      std::vector<Token> batch;
+      while (tokenizer.next(token)) {
+        if (token.type == Token::Type::Positional) {
+          if (!_options->apply(batch) || !_options->apply(token)) {
+            return false;
+          }
+          batch.clear();
+          continue;
+        }
+        batch.emplace_back(std::move(token));
+        if (batch.size() == BatchSize) {
+          if (!_options->apply(batch)) {
+            return false;
+          }
+          batch.clear();
+        }
+      }
+      return _options->apply(batch);
+    }
+
+    while (tokenizer.next(token)) {
+      if (!_options->apply(token)) {
+        return false;
+      }
     }
 
     // all is well
@@ -111,7 +285,12 @@ class ArgumentParser {
   }
 
  private:
+  // number of tokens applied at once if values are validated concurrently
+  enum : size_t { BatchSize = 1024 };
+
   ProgramOptions* _options;
+  // whether or not "@<file>" arguments are expanded
+  bool _responseFiles;
 };
 }
 }
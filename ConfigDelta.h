@@ -0,0 +1,161 @@
+#ifndef ARANGODB_PROGRAM_OPTIONS_CONFIG_DELTA_H
+#define ARANGODB_PROGRAM_OPTIONS_CONFIG_DELTA_H 1
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+
+#include "ProgramOptions.h"
+
+namespace arangodb {
+namespace options {
+
+// compact snapshot of all options whose values differ from their defaults
+// entries are keyed by the stable option id (see Option::stableId()) and
+// sorted by it, so deltas captured in different processes can be compared
+// in linear time. values are stored in JSON format
+// static options (see ProgramOptions::addStaticSchema()) are not included
+class ConfigDelta {
+ public:
+  // a single option with a non-default value
+  struct Entry {
+    Entry(uint64_t id, std::string const& value) : id(id), value(value) {}
+
+    uint64_t id;
+    std::string value;
+  };
+
+  // a single difference between two deltas. a nullptr value means that the
+  // option has its default value on that side. the pointers refer to the
+  // values stored in the compared deltas
+  struct Difference {
+    Difference(uint64_t id, std::string const* left, std::string const* right)
+        : id(id), left(left), right(right) {}
+
+    uint64_t id;
+    std::string const* left;
+    std::string const* right;
+  };
+
+  // create an empty delta
+  ConfigDelta() {}
+
+  // capture the delta of the current option values. options are compared
+  // against the defaults captured when they were added, so values that were
+  // changed by the application after adding an option show up here as well
+  explicit ConfigDelta(ProgramOptions* options) {
+    std::string value;
+    options->walk([this, options, &value](Section const&,
+                                          Option const& option) {
+      value.clear();
+      options->variant(option).appendJson(value);
+      if (value != options->defaultValue(option)) {
+        _entries.emplace_back(option.stableId(), value);
+      }
+    }, false);
+
+    std::sort(_entries.begin(), _entries.end(),
+              [](Entry const& lhs, Entry const& rhs) { return lhs.id < rhs.id; });
+
+    for (size_t i = 1; i < _entries.size(); ++i) {
+      if (_entries[i - 1].id == _entries[i].id) {
+        throw std::logic_error("stable option id collision");
+      }
+    }
+  }
+
+  // the options with non-default values, sorted by stable id
+  std::vector<Entry> const& entries() const { return _entries; }
+
+  // whether or not all options have their default values
+  bool empty() const { return _entries.empty(); }
+
+  // serialize the delta into a reusable buffer, which is cleared first.
+  // each entry is written as a line with the id in hex and the value
+  void serialize(std::string& out) const {
+    static char const* digits = "0123456789abcdef";
+
+    out.clear();
+    for (auto const& it : _entries) {
+      for (int shift = 60; shift >= 0; shift -= 4) {
+        out.push_back(digits[(it.id >> shift) & 0xf]);
+      }
+      out.push_back(' ');
+      out.append(it.value);
+      out.push_back('\n');
+    }
+  }
+
+  // read a delta as produced by serialize(). returns false if the input is
+  // malformed, in which case the delta is left empty
+  bool deserialize(std::string const& data) {
+    _entries.clear();
+
+    size_t pos = 0;
+    while (pos < data.size()) {
+      size_t const end = data.find('\n', pos);
+      if (end == std::string::npos || end - pos < 18 || data[pos + 16] != ' ') {
+        _entries.clear();
+        return false;
+      }
+
+      uint64_t id = 0;
+      for (size_t i = pos; i < pos + 16; ++i) {
+        char const c = data[i];
+        if (c >= '0' && c <= '9') {
+          id = (id << 4) | static_cast<uint64_t>(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+          id = (id << 4) | static_cast<uint64_t>(c - 'a' + 10);
+        } else {
+          _entries.clear();
+          return false;
+        }
+      }
+
+      if (!_entries.empty() && _entries.back().id >= id) {
+        // entries must be sorted and unique
+        _entries.clear();
+        return false;
+      }
+
+      _entries.emplace_back(id, data.substr(pos + 17, end - pos - 17));
+      pos = end + 1;
+    }
+
+    return true;
+  }
+
+  // compute the differences between two deltas in a single linear pass.
+  // the differences are appended to result, sorted by stable id
+  static void diff(ConfigDelta const& left, ConfigDelta const& right,
+                   std::vector<Difference>& result) {
+    auto l = left._entries.begin();
+    auto r = right._entries.begin();
+
+    while (l != left._entries.end() || r != right._entries.end()) {
+      if (r == right._entries.end() ||
+          (l != left._entries.end() && (*l).id < (*r).id)) {
+        result.emplace_back((*l).id, &(*l).value, nullptr);
+        ++l;
+      } else if (l == left._entries.end() || (*r).id < (*l).id) {
+        result.emplace_back((*r).id, nullptr, &(*r).value);
+        ++r;
+      } else {
+        if ((*l).value != (*r).value) {
+          result.emplace_back((*l).id, &(*l).value, &(*r).value);
+        }
+        ++l;
+        ++r;
+      }
+    }
+  }
+
+ private:
+  std::vector<Entry> _entries;
+};
+}
+}
+
+#endif
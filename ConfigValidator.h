@@ -0,0 +1,164 @@
+#ifndef ARANGODB_PROGRAM_OPTIONS_CONFIG_VALIDATOR_H
+#define ARANGODB_PROGRAM_OPTIONS_CONFIG_VALIDATOR_H 1
+
+#include <string>
+#include <vector>
+
+#include "IniFileParser.h"
+#include "ProgramOptions.h"
+#include "ThreadPool.h"
+#include "Token.h"
+
+namespace arangodb {
+namespace options {
+
+// validator for config files
+// checks config files against the options, without setting any values:
+// option names are looked up, and values are checked via
+// Parameter::check(), so the destination variables are never written to.
+// many files can be validated in parallel against a schema that is only
+// registered once
+class ConfigValidator {
+ public:
+  // a single problem found in a config file
+  struct Error {
+    Error(std::string const& file, size_t line, std::string const& option,
+          std::string const& message)
+        : file(file), line(line), option(option), message(message) {}
+
+    // the file the error was found in. this is the validated file or a file
+    // included by it
+    std::string file;
+    // line number, 0 if the error is not related to a line
+    size_t line;
+    // option name, empty if the error is not related to an option
+    std::string option;
+    std::string message;
+  };
+
+  // validation result for a single file
+  struct Result {
+    explicit Result(std::string const& file) : file(file) {}
+
+    bool ok() const { return errors.empty(); }
+
+    std::string file;
+    // all problems found, in file order
+    std::vector<Error> errors;
+  };
+
+  // create a validator. this registers the options of all lazy sections,
+  // so that no options are registered while files are validated
+  explicit ConfigValidator(ProgramOptions* options) : _options(options) {
+    _options->walk([](Section const&, Option const&) {}, false);
+  }
+
+  // validate a single config file
+  Result validate(std::string const& file) const {
+    Result result(file);
+    IniFileParser::Tokenizer tokenizer(file);
+    Token token;
+
+    while (tokenizer.next(token)) {
+      if (token.type == Token::Type::Error) {
+        result.errors.emplace_back(token.location.name,
+                                   token.location.position, "", token.value);
+        continue;
+      }
+
+      std::string const message = token.type == Token::Type::Clear
+                                      ? checkClear(token.option)
+                                      : check(token.option, token.value);
+      if (!message.empty()) {
+        result.errors.emplace_back(token.location.name,
+                                   token.location.position, token.option,
+                                   message);
+      }
+    }
+
+    return result;
+  }
+
+  // validate many config files in parallel. the results are returned in
+  // the order of the files
+  std::vector<Result> validate(
+      std::vector<std::string> const& files,
+      size_t concurrency = ThreadPool::defaultConcurrency()) const {
+    std::vector<Result> results;
+    results.reserve(files.size());
+    for (auto const& it : files) {
+      results.emplace_back(it);
+    }
+
+    ThreadPool pool((std::min)(concurrency, files.size()));
+    pool.run(files.size(),
+             [this, &files, &results](size_t i) {
+               results[i] = validate(files[i]);
+             });
+
+    return results;
+  }
+
+ private:
+  // check a single value. returns an error message, or an empty string if
+  // the value is valid
+  // all lazy sections were registered in the constructor, so the lookups
+  // below do not modify the options and can run concurrently
+  std::string check(std::string const& name, std::string const& value) const {
+    ProgramOptions* options = _options;
+
+    StaticOption const* staticOption = options->findStaticOption(name);
+    if (staticOption != nullptr) {
+      return staticOption->check(value);
+    }
+
+    auto parts = Option::splitName(name);
+    Section const* section = options->findSection(parts.first);
+    if (section != nullptr && section->obsolete) {
+      // section is obsolete. ignore it
+      return "";
+    }
+
+    Option const* option = options->findOption(name);
+    if (option == nullptr) {
+      return "unknown option '" + name + "'";
+    }
+    if (option->obsolete) {
+      // option is obsolete. ignore it
+      return "";
+    }
+
+    return options->variant(*option).check(value);
+  }
+
+  // check that the values of an option can be cleared. returns an error
+  // message, or an empty string if the option accepts multiple values
+  std::string checkClear(std::string const& name) const {
+    ProgramOptions* options = _options;
+
+    if (options->findStaticOption(name) == nullptr) {
+      auto parts = Option::splitName(name);
+      Section const* section = options->findSection(parts.first);
+      if (section != nullptr && section->obsolete) {
+        // section is obsolete. ignore it
+        return "";
+      }
+
+      Option const* option = options->findOption(name);
+      if (option == nullptr) {
+        return "unknown option '" + name + "'";
+      }
+      if (option->obsolete || options->variant(*option).multipleValues()) {
+        return "";
+      }
+    }
+
+    return "option '" + name + "' does not accept multiple values";
+  }
+
+  ProgramOptions* _options;
+};
+}
+}
+
+#endif
@@ -0,0 +1,339 @@
+#ifndef ARANGODB_PROGRAM_OPTIONS_CONFIG_WATCHER_H
+#define ARANGODB_PROGRAM_OPTIONS_CONFIG_WATCHER_H 1
+
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "IniFileParser.h"
+
+namespace arangodb {
+namespace options {
+
+// watcher for changes of config files, based on inotify
+// the directories containing the watched files are watched instead of the
+// files themselves, so that files replaced via rename (as written by most
+// deployment tools) are detected, and one watch serves all files of a
+// directory. changes are debounced: the reload callback is called once all
+// changes have been quiet for the debounce window, with the names of all
+// files changed since the last call. events are processed by poll(), which
+// is either called by a single background thread started via start(), or
+// by the application itself
+// only supported on Linux. watching fails and start() returns false
+// elsewhere
+class ConfigWatcher {
+ public:
+  typedef std::function<void(std::vector<std::string> const&)> ReloadFuncType;
+
+  // no need to copy this
+  ConfigWatcher(ConfigWatcher const&) = delete;
+  ConfigWatcher& operator=(ConfigWatcher const&) = delete;
+
+  explicit ConfigWatcher(
+      ReloadFuncType const& reload,
+      std::chrono::milliseconds window = std::chrono::milliseconds(100))
+      : _reload(reload),
+        _window(window),
+        _fd(-1),
+        _wakeFd(-1),
+        _overflow(false),
+        _stop(false) {
+#ifdef __linux__
+    _fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    _wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+  }
+
+  ~ConfigWatcher() {
+    stop();
+#ifdef __linux__
+    if (_fd != -1) {
+      ::close(_fd);
+    }
+    if (_wakeFd != -1) {
+      ::close(_wakeFd);
+    }
+#endif
+  }
+
+  // watch a config file. the file does not need to exist yet, but its
+  // directory does. returns true if all is well, false otherwise
+  bool watchFile(std::string const& name) {
+    size_t const pos = name.find_last_of('/');
+    if (pos == std::string::npos) {
+      return addWatch(".", name, name);
+    }
+    return addWatch(name.substr(0, pos + 1), name.substr(pos + 1), name);
+  }
+
+  // watch all config files in a directory that are included by
+  // "@include-dir", including files that are added later. returns true if
+  // all is well, false otherwise
+  bool watchDirectory(std::string const& name) {
+    if (name.empty()) {
+      return addWatch(".", "", "./");
+    }
+    return addWatch(name, "", name);
+  }
+
+  // watch all files and directories consumed by a parser. returns true if
+  // all is well, false otherwise
+  bool watch(IniFileParser const& parser) {
+    bool result = true;
+    for (auto const& it : parser.files()) {
+      result &= watchFile(it);
+    }
+    for (auto const& it : parser.directories()) {
+      result &= watchDirectory(it);
+    }
+    return result;
+  }
+
+  // start a background thread that processes events and calls the reload
+  // callback. returns false if watching is not supported
+  bool start() {
+    if (_fd == -1 || _wakeFd == -1 || _thread.joinable()) {
+      return false;
+    }
+    _stop.store(false);
+    _thread = std::thread([this]() {
+      while (!_stop.load()) {
+        poll(-1);
+      }
+    });
+    return true;
+  }
+
+  // stop the background thread. changes that are still being debounced are
+  // not reported
+  void stop() {
+    if (!_thread.joinable()) {
+      return;
+    }
+    _stop.store(true);
+    wake();
+    _thread.join();
+  }
+
+  // process events, waiting at most timeout milliseconds for them (-1 for
+  // no limit) or until the debounce window of pending changes has passed.
+  // calls the reload callback if changes are pending and have been quiet
+  // for the debounce window. the callback is called on the thread calling
+  // poll(), and may watch further files
+  void poll(int timeout) {
+#ifdef __linux__
+    if (_fd == -1) {
+      return;
+    }
+
+    if (pending()) {
+      // wake up when the debounce window has passed
+      auto const remaining =
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              _lastChange + _window - std::chrono::steady_clock::now())
+              .count();
+      int const wait = remaining > 0 ? static_cast<int>(remaining) + 1 : 0;
+      if (timeout < 0 || wait < timeout) {
+        timeout = wait;
+      }
+    }
+
+    struct pollfd fds[2];
+    fds[0].fd = _fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = _wakeFd;
+    fds[1].events = POLLIN;
+    if (::poll(fds, _wakeFd == -1 ? 1 : 2, timeout) > 0) {
+      if (fds[1].revents & POLLIN) {
+        uint64_t value;
+        if (::read(_wakeFd, &value, sizeof(value)) < 0) {
+          // nothing to do
+        }
+      }
+      if (fds[0].revents & POLLIN) {
+        readEvents();
+      }
+    }
+
+    if (pending() &&
+        std::chrono::steady_clock::now() - _lastChange >= _window) {
+      std::vector<std::string> changed;
+      {
+        std::lock_guard<std::mutex> guard(_mutex);
+        if (_overflow) {
+          // events were lost. report all watched files
+          for (auto const& it : _directories) {
+            if (!it.second.path.empty()) {
+              changed.emplace_back(it.second.path);
+            }
+            for (auto const& file : it.second.files) {
+              changed.emplace_back(file.second);
+            }
+          }
+        } else {
+          changed.assign(_changed.begin(), _changed.end());
+        }
+        _changed.clear();
+        _overflow = false;
+      }
+      _reload(changed);
+    }
+#else
+    (void)timeout;
+#endif
+  }
+
+ private:
+  // a watched directory
+  struct Directory {
+    // name of the directory as passed to watchDirectory(), if all config
+    // files in the directory are watched. empty otherwise
+    std::string path;
+    // watched files in the directory, mapped to the names they were
+    // watched by
+    std::map<std::string, std::string> files;
+  };
+
+  // watch the file named file in a directory, or all config files in it if
+  // file is empty. name is reported to the callback
+  bool addWatch(std::string const& directory, std::string const& file,
+                std::string const& name) {
+#ifdef __linux__
+    if (_fd == -1) {
+      return false;
+    }
+
+    // adding a watch for an already watched directory returns the same
+    // watch descriptor
+    int const wd = ::inotify_add_watch(
+        _fd, directory.c_str(), IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE |
+                                    IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO);
+    if (wd == -1) {
+      return false;
+    }
+
+    std::lock_guard<std::mutex> guard(_mutex);
+    Directory& entry = _directories[wd];
+    if (file.empty()) {
+      entry.path = name;
+      if (entry.path.back() != '/') {
+        entry.path.push_back('/');
+      }
+    } else {
+      entry.files.emplace(file, name);
+    }
+    return true;
+#else
+    (void)directory;
+    (void)file;
+    (void)name;
+    return false;
+#endif
+  }
+
+  // whether or not changes are waiting for the debounce window to pass
+  bool pending() {
+    std::lock_guard<std::mutex> guard(_mutex);
+    return _overflow || !_changed.empty();
+  }
+
+  // wake up the thread waiting in poll()
+  void wake() {
+#ifdef __linux__
+    if (_wakeFd != -1) {
+      uint64_t const value = 1;
+      if (::write(_wakeFd, &value, sizeof(value)) < 0) {
+        // the counter is already non-zero
+      }
+    }
+#endif
+  }
+
+#ifdef __linux__
+  // read all available events and record the changed files
+  void readEvents() {
+    alignas(struct inotify_event) char buffer[16384];
+
+    while (true) {
+      ssize_t const length = ::read(_fd, buffer, sizeof(buffer));
+      if (length <= 0) {
+        // no more events (EAGAIN), or an error
+        return;
+      }
+
+      std::lock_guard<std::mutex> guard(_mutex);
+      for (char const* p = buffer; p < buffer + length;) {
+        auto const* event = reinterpret_cast<struct inotify_event const*>(p);
+        p += sizeof(struct inotify_event) + event->len;
+
+        if (event->mask & IN_Q_OVERFLOW) {
+          _overflow = true;
+          _lastChange = std::chrono::steady_clock::now();
+          continue;
+        }
+        if (event->len == 0) {
+          // event for the directory itself
+          continue;
+        }
+
+        auto it = _directories.find(event->wd);
+        if (it == _directories.end()) {
+          continue;
+        }
+        Directory const& directory = (*it).second;
+        std::string const name(event->name);
+        auto file = directory.files.find(name);
+        if (file != directory.files.end()) {
+          _changed.emplace((*file).second);
+        } else if (!directory.path.empty() &&
+                   IniFileParser::isConfigFile(name)) {
+          _changed.emplace(directory.path + name);
+        } else {
+          continue;
+        }
+        _lastChange = std::chrono::steady_clock::now();
+      }
+    }
+  }
+#endif
+
+  ReloadFuncType _reload;
+  // changes must be quiet for this long before the callback is called
+  std::chrono::milliseconds _window;
+  // inotify instance
+  int _fd;
+  // eventfd for waking up poll()
+  int _wakeFd;
+  // protects _directories, _changed and _overflow
+  std::mutex _mutex;
+  // watched directories, by watch descriptor
+  std::unordered_map<int, Directory> _directories;
+  // names of the files changed since the callback was last called
+  std::set<std::string> _changed;
+  // whether or not events were lost since the callback was last called
+  bool _overflow;
+  // time of the last change
+  std::chrono::steady_clock::time_point _lastChange;
+  // background thread, if started
+  std::thread _thread;
+  std::atomic<bool> _stop;
+};
+}
+}
+
+#endif
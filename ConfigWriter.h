@@ -0,0 +1,89 @@
+#ifndef ARANGODB_PROGRAM_OPTIONS_CONFIG_WRITER_H
+#define ARANGODB_PROGRAM_OPTIONS_CONFIG_WRITER_H 1
+
+#include <string>
+
+#include "Parameters.h"
+#include "ProgramOptions.h"
+
+namespace arangodb {
+namespace options {
+
+// serializer for the effective configuration
+// values are appended straight into a caller-provided buffer, which is
+// cleared first, so the same buffer can be reused for multiple dumps
+// static options (see ProgramOptions::addStaticSchema()) are not written
+class ConfigWriter {
+ public:
+  explicit ConfigWriter(ProgramOptions* options) : _options(options) {}
+
+  // write the options in ini format. the output can be parsed back with
+  // IniFileParser. the values of vector options are preceded by a clear
+  // directive, so that they replace the vector's default values when parsed
+  // back. note that ini files cannot express string values with leading
+  // blanks or line breaks
+  void writeIni(std::string& out, bool onlyTouched) {
+    out.clear();
+
+    std::string const* currentSection = nullptr;
+    _options->walk([this, &out, &currentSection](Section const& section,
+                                                 Option const& option) {
+      ParameterVariant const& parameter = _options->variant(option);
+      size_t const n = parameter.valueCount();
+      bool const multiple = parameter.multipleValues();
+
+      if (n == 0 && !multiple) {
+        return;
+      }
+
+      if (currentSection == nullptr || *currentSection != section.name) {
+        if (!section.name.empty() || currentSection != nullptr) {
+          if (!out.empty()) {
+            out.push_back('\n');
+          }
+          out.push_back('[');
+          out.append(section.name);
+          out.append("]\n");
+        }
+        currentSection = &section.name;
+      }
+
+      if (multiple) {
+        out.append("@clear ");
+        out.append(option.name);
+        out.push_back('\n');
+      }
+
+      for (size_t i = 0; i < n; ++i) {
+        out.append(option.name);
+        out.append(" = ");
+        parameter.appendValue(out, i);
+        out.push_back('\n');
+      }
+    }, onlyTouched);
+  }
+
+  // write the options as a JSON object, keyed by full option name
+  void writeJson(std::string& out, bool onlyTouched) {
+    out.clear();
+    out.push_back('{');
+
+    bool first = true;
+    _options->walk([this, &out, &first](Section const&, Option const& option) {
+      out.append(first ? "\n  " : ",\n  ");
+      first = false;
+      appendJsonString(out, option.fullName());
+      out.append(": ");
+      _options->variant(option).appendJson(out);
+    }, onlyTouched);
+
+    out.append(first ? "}\n" : "\n}\n");
+  }
+
+ private:
+  ProgramOptions* _options;
+};
+}
+}
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef ARANGODB_PROGRAM_OPTIONS_ENVIRONMENT_PARSER_H
+#define ARANGODB_PROGRAM_OPTIONS_ENVIRONMENT_PARSER_H 1
+
+#include <string>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ProgramOptions.h"
+#include "Token.h"
+
+#ifdef _WIN32
+#include <stdlib.h>
+#define ARANGODB_PROGRAM_OPTIONS_ENVIRON _environ
+#else
+extern char** environ;
+#define ARANGODB_PROGRAM_OPTIONS_ENVIRON environ
+#endif
+
+namespace arangodb {
+namespace options {
+
+// parser for options specified as environment variables
+// an option is mapped to an environment variable by upper-casing its name,
+// replacing '-' with '_' and joining section and option name with "__",
+// all prefixed with a program-specific prefix. for example, with prefix
+// "APP_", the option --database.journal-size is mapped to the environment
+// variable APP_DATABASE__JOURNAL_SIZE
+// the values are applied via ProgramOptions::setValue() like the values from
+// the other parsers, so the last source parsed wins
+// the options of lazy sections are only registered if a variable with the
+// section's prefix exists
+class EnvironmentParser {
+ public:
+  // create a parser for the given prefix. the options must be sealed, as the
+  // mapping from environment variable names to options is built here once
+  EnvironmentParser(ProgramOptions* options, std::string const& prefix)
+      : _options(options), _prefix(prefix) {
+    if (!_options->sealed()) {
+      throw std::logic_error(
+          "program options must be sealed before creating an environment "
+          "parser");
+    }
+
+    _options->walk([this](Section const&, Option const& option) {
+      addVariable(option);
+    }, false, false);
+
+    // static options are not visited by walk()
+    for (auto const& schema : _options->staticSchemas()) {
+      for (size_t i = 0; i < schema->size(); ++i) {
+        addVariable(schema->option(i).toOption());
+      }
+    }
+
+    for (auto const& it : _options->lazySections()) {
+      std::string prefix(_prefix);
+      appendName(prefix, it);
+      prefix.append("__");
+      _lazyPrefixes.emplace_back(prefix, it);
+    }
+  }
+
+  // get the name of the environment variable for an option
+  static std::string variableName(std::string const& prefix,
+                                  Option const& option) {
+    std::string result(prefix);
+    if (!option.section.empty()) {
+      appendName(result, option.section);
+      result.append("__");
+    }
+    appendName(result, option.name);
+    return result;
+  }
+
+  // parse options from the process environment. returns true if all is
+  // well, false otherwise
+  // errors that occur during parse are reported to _options
+  bool parse() { return parse(ARANGODB_PROGRAM_OPTIONS_ENVIRON); }
+
+  // parse options from a nullptr-terminated array of "NAME=VALUE" strings,
+  // e.g. the envp argument of main(). returns true if all is well, false
+  // otherwise
+  bool parse(char** environment) {
+    if (environment == nullptr) {
+      return true;
+    }
+
+    SourceLocation location(SourceType::Environment, "", 0);
+    std::string name;
+
+    for (char** it = environment; *it != nullptr; ++it) {
+      char const* current = *it;
+
+      // cheap check first, as most variables will not belong to us
+      if (strncmp(current, _prefix.c_str(), _prefix.size()) != 0) {
+        continue;
+      }
+
+      char const* equals = strchr(current, '=');
+      if (equals == nullptr) {
+        continue;
+      }
+
+      name.assign(current, equals - current);
+      auto found = _variables.find(name);
+
+      if (found == _variables.end()) {
+        if (!addLazySection(name)) {
+          continue;
+        }
+        found = _variables.find(name);
+        if (found == _variables.end()) {
+          continue;
+        }
+      }
+
+      // set location for parsing (used in error messages)
+      location.name = name;
+      _options->setLocation(location);
+
+      if (!_options->setValue((*found).second, std::string(equals + 1))) {
+        return false;
+      }
+    }
+
+    // all is well
+    return true;
+  }
+
+ private:
+  // add the environment variable for an option
+  void addVariable(Option const& option) {
+    if (!_variables.emplace(variableName(_prefix, option), option.fullName())
+             .second) {
+      throw std::logic_error(
+          std::string("environment variable already defined for option ") +
+          option.displayName());
+    }
+  }
+
+  // register the options of the lazy section a variable belongs to.
+  // returns false if the variable does not belong to a lazy section
+  bool addLazySection(std::string const& name) {
+    for (auto it = _lazyPrefixes.begin(); it != _lazyPrefixes.end(); ++it) {
+      if (name.compare(0, (*it).first.size(), (*it).first) != 0) {
+        continue;
+      }
+
+      Section const* section = _options->findSection((*it).second);
+      _lazyPrefixes.erase(it);
+
+      if (section == nullptr || section->obsolete) {
+        return false;
+      }
+      for (auto const& it2 : section->options) {
+        if (!it2.second.obsolete) {
+          addVariable(it2.second);
+        }
+      }
+      return true;
+    }
+    return false;
+  }
+
+  // append an upper-cased option or section name, replacing '-' with '_'
+  static void appendName(std::string& result, std::string const& name) {
+    for (char c : name) {
+      if (c == '-') {
+        result.push_back('_');
+      } else if (c >= 'a' && c <= 'z') {
+        result.push_back(static_cast<char>(c - 'a' + 'A'));
+      } else {
+        result.push_back(c);
+      }
+    }
+  }
+
+  ProgramOptions* _options;
+  // prefix for all environment variables
+  std::string _prefix;
+  // environment variable names, mapped to full option names
+  std::unordered_map<std::string, std::string> _variables;
+  // variable name prefixes of lazy sections whose variables have not been
+  // added yet, with the section names
+  std::vector<std::pair<std::string, std::string>> _lazyPrefixes;
+};
+}
+}
+
+#endif
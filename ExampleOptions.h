@@ -0,0 +1,142 @@
+#ifndef ARANGODB_PROGRAM_OPTIONS_EXAMPLE_OPTIONS_H
+#define ARANGODB_PROGRAM_OPTIONS_EXAMPLE_OPTIONS_H 1
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "Parameters.h"
+#include "ProgramOptions.h"
+#include "Section.h"
+
+// the options of the example program, shared by the example and the config
+// file validator
+
+// a custom parameter type for port numbers
+struct PortParameter : public arangodb::options::Parameter {
+  typedef uint32_t ValueType;
+
+  explicit PortParameter(ValueType* ptr) : ptr(ptr) {}
+
+  std::string name() const override { return "port number"; }
+
+  std::string valueString() const override { return std::to_string(*ptr); }
+
+  std::string set(std::string const& value) override {
+    std::string result = check(value);
+    if (result.empty()) {
+      *ptr = static_cast<uint32_t>(std::stoull(value));
+    }
+    return result;
+  }
+
+  // check a value without setting it, e.g. for validating config files
+  std::string check(std::string const& value) const override {
+    try {
+      uint32_t v = static_cast<uint32_t>(std::stoull(value));
+      if (v >= 1024 && v <= 65535) {
+        return "";
+      }
+    } catch (...) {
+      return "invalid numeric value";
+    }
+    return "number out of range (port number must be between 1024 and 65535)";
+  }
+
+  // set a value that was already checked, e.g. when validating in parallel
+  std::string setValidated(std::string const& value) override {
+    *ptr = static_cast<uint32_t>(std::stoull(value));
+    return "";
+  }
+
+  ValueType* ptr;
+};
+
+// storage engines, for use with a DiscreteValuesParameter
+enum class StorageEngine { MMFiles, RocksDB };
+
+// destination variables for option values
+struct ExampleOptions {
+  std::string configFile;
+  std::vector<std::string> endpoints = {"tcp://127.0.0.1:80",
+                                        "ssl://192.168.0.1:443"};
+  std::vector<uint32_t> ports = {8529, 16384};
+  uint32_t journalSize = 16 * 1024 * 1024;
+  bool quiet = false;
+  bool noServer = false;
+  bool waitForSync = false;
+  bool crashMe = false;
+  int32_t int32 = 1;
+  uint32_t uint32 = 0;
+  uint32_t bounded = 99;
+  StorageEngine storageEngine = StorageEngine::RocksDB;
+};
+
+// set up the sections and options of the example program
+inline void addExampleOptions(arangodb::options::ProgramOptions& options,
+                              ExampleOptions& values) {
+  using namespace arangodb::options;
+
+  // set up some basic sections
+
+  // global (unnamed section)
+  options.addSection(Section("", "Global options description goes here",
+                             "global options", false, false));
+  options.addOption("--quiet,-q", "tell the server to be quiet",
+                    new BooleanParameter(&values.quiet, false));
+  options.addOption("--no-server", "don't start server at all",
+                    new BooleanParameter(&values.noServer, false));
+  options.addOption("--configuration,-c", "parse configuration file",
+                    new StringParameter(&values.configFile));
+  options.addOption("--version", "prints version information",
+                    new ObsoleteParameter());
+
+  // "server" options section
+  options.addSection("server", "Server options description goes here");
+  options.addOption("--server.endpoints,-e", "server endpoints",
+                    new VectorParameter<StringParameter>(&values.endpoints));
+  options.addOption("--server.ports", "the server ports",
+                    new VectorParameter<PortParameter>(&values.ports));
+  options.addOption("--server.int32-value", "an int32 value",
+                    new Int32Parameter(&values.int32));
+  options.addOption("--server.uint32-value", "a uint32 value",
+                    new UInt32Parameter(&values.uint32));
+  options.addOption("--server.bounded-value", "a bounded uint32 value",
+                    new BoundedParameter<UInt32Parameter>(&values.bounded, 42,
+                                                          8193));
+  options.addOption("--server.storage-engine", "the storage engine",
+                    new DiscreteValuesParameter<StorageEngine>(
+                        &values.storageEngine,
+                        {{"mmfiles", StorageEngine::MMFiles},
+                         {"rocksdb", StorageEngine::RocksDB}}));
+
+  // "database" options section
+  options.addSection("database", "Database options description goes here");
+  options.addOption("--database.journal-size", "maximal journal size",
+                    new UInt32Parameter(&values.journalSize));
+  options.addOption("--database.wait-for-sync", "wait for sync description",
+                    new BooleanParameter(&values.waitForSync));
+
+  // hidden section
+  options.addHiddenSection("debugging",
+                           "Debugging options description goes here");
+  options.addOption("--debugging.crash-me",
+                    "whatever (option can still be used but it is not shown)",
+                    new BooleanParameter(&values.crashMe));
+  options.addObsoleteOption("--debugging.not-used-anymore",
+                            "whatever (obsolete)");
+
+  // obsolete section (all options in this section do nothing)
+  options.addObsoleteSection("y2kbug");
+
+  // constraints between options, checked after all options are parsed
+  options.addConstraint({"server.endpoints", "server.ports"},
+                        "one port per endpoint", [&values]() {
+    if (values.endpoints.size() != values.ports.size()) {
+      return std::string("number of endpoints and ports differs");
+    }
+    return std::string();
+  });
+}
+
+#endif
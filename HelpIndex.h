@@ -0,0 +1,171 @@
+#ifndef ARANGODB_PROGRAM_OPTIONS_HELP_INDEX_H
+#define ARANGODB_PROGRAM_OPTIONS_HELP_INDEX_H 1
+
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+
+#include "Option.h"
+#include "Section.h"
+
+namespace arangodb {
+namespace options {
+
+// inverted index over the words of option names and descriptions, for
+// searching the help. hidden and obsolete options and the options of hidden
+// sections are not indexed, as they are not shown in the help either
+class HelpIndex {
+ public:
+  // build the index for the options of the given sections
+  explicit HelpIndex(std::map<std::string, Section> const& sections) {
+    for (auto const& it : sections) {
+      if (it.second.hidden || it.second.obsolete) {
+        continue;
+      }
+      for (auto const& it2 : it.second.options) {
+        if (it2.second.hidden || it2.second.obsolete) {
+          continue;
+        }
+        addOption(it2.second);
+      }
+    }
+  }
+
+  // number of indexed options
+  size_t size() const { return _options.size(); }
+
+  // find the options matching any of the words in terms. a word matches
+  // a word of an option if it is equal to it or a prefix of it, and matches
+  // in the option name count more than matches in the description. the
+  // results are ranked by the number of words matched, then by score, then
+  // by name
+  std::vector<Option const*> search(std::string const& terms) const {
+    std::vector<std::string> words;
+    tokenize(terms, [&words](std::string const& word) {
+      if (std::find(words.begin(), words.end(), word) == words.end()) {
+        words.emplace_back(word);
+      }
+    });
+
+    // number of words matched and score, by option index
+    std::unordered_map<uint32_t, MatchType> matches;
+    std::unordered_map<uint32_t, uint32_t> best;
+
+    for (auto const& word : words) {
+      // best score of this word for each option
+      best.clear();
+      for (auto it = _postings.lower_bound(word);
+           it != _postings.end() &&
+           (*it).first.compare(0, word.size(), word) == 0;
+           ++it) {
+        // exact matches count twice as much as prefix matches
+        uint32_t const factor = ((*it).first.size() == word.size()) ? 2 : 1;
+        for (auto const& posting : (*it).second) {
+          uint32_t& score = best[posting.option];
+          score = (std::max)(score, posting.weight * factor);
+        }
+      }
+      for (auto const& it : best) {
+        auto& match = matches[it.first];
+        ++match.first;
+        match.second += it.second;
+      }
+    }
+
+    std::vector<std::pair<uint32_t, MatchType>> ranked(matches.begin(),
+                                                       matches.end());
+    std::sort(ranked.begin(), ranked.end(),
+              [this](std::pair<uint32_t, MatchType> const& lhs,
+                     std::pair<uint32_t, MatchType> const& rhs) {
+                if (lhs.second != rhs.second) {
+                  return lhs.second > rhs.second;
+                }
+                return _names[lhs.first] < _names[rhs.first];
+              });
+
+    std::vector<Option const*> result;
+    result.reserve(ranked.size());
+    for (auto const& it : ranked) {
+      result.emplace_back(&_options[it.first]);
+    }
+    return result;
+  }
+
+ private:
+  // number of words matched and score of an option
+  typedef std::pair<uint32_t, uint32_t> MatchType;
+
+  // weights of the places a word can occur in
+  enum : uint32_t { DescriptionWeight = 1, NameWeight = 4 };
+
+  // an occurrence of a word in an option
+  struct Posting {
+    Posting(uint32_t option, uint32_t weight)
+        : option(option), weight(weight) {}
+
+    // option index
+    uint32_t option;
+    // sum of the weights of all places the word occurs in
+    uint32_t weight;
+  };
+
+  // split a string into lower-case words of letters and digits, and call
+  // the callback for each of them
+  template <typename F>
+  static void tokenize(std::string const& value, F const& callback) {
+    std::string word;
+    for (char c : value) {
+      if (std::isalnum(static_cast<unsigned char>(c))) {
+        word.push_back(
+            static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+      } else if (!word.empty()) {
+        callback(word);
+        word.clear();
+      }
+    }
+    if (!word.empty()) {
+      callback(word);
+    }
+  }
+
+  void addOption(Option const& option) {
+    uint32_t const index = static_cast<uint32_t>(_options.size());
+    _options.emplace_back(option);
+    _names.emplace_back(option.fullName());
+
+    // weight of each word of the option
+    std::unordered_map<std::string, uint32_t> weights;
+    auto add = [&weights](std::string const& word, uint32_t weight) {
+      uint32_t& value = weights[word];
+      // count each place only once
+      if ((value & weight) == 0) {
+        value += weight;
+      }
+    };
+    tokenize(_names.back(), [&add](std::string const& word) {
+      add(word, NameWeight);
+    });
+    tokenize(option.description, [&add](std::string const& word) {
+      add(word, DescriptionWeight);
+    });
+
+    for (auto const& it : weights) {
+      _postings[it.first].emplace_back(index, it.second);
+    }
+  }
+
+  // the indexed options
+  std::vector<Option> _options;
+  // full names of the indexed options
+  std::vector<std::string> _names;
+  // occurrences of each word, sorted by word for prefix lookups
+  std::map<std::string, std::vector<Posting>> _postings;
+};
+}
+}
+
+#endif
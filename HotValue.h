@@ -0,0 +1,134 @@
+#ifndef ARANGODB_PROGRAM_OPTIONS_HOT_VALUE_H
+#define ARANGODB_PROGRAM_OPTIONS_HOT_VALUE_H 1
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+
+#include "ProgramOptions.h"
+#include "ThreadPool.h"
+
+namespace arangodb {
+namespace options {
+
+// read-optimized copy of an option value that is read by many threads,
+// e.g. a timeout or a batch size that is looked up for every request.
+// the value is replicated into cache-line-sized slots, and each reading
+// thread sticks to one slot. reads therefore never touch a cache line that
+// is shared with readers on other cores, and updating the value does not
+// invalidate more than one cache line per slot.
+// the replicas are updated whenever a value is set for the option via
+// ProgramOptions::setValue(), until the HotValue is destroyed. the options
+// must outlive the HotValue.
+// reads are recorded by the options' read profiler, if one was attached
+// when the HotValue was created
+template <typename T>
+class HotValue {
+ public:
+  // size of a replica slot, i.e. the size of a cache line
+  enum : size_t { SlotSize = 64 };
+
+  // no need to copy this
+  HotValue(HotValue const&) = delete;
+  HotValue& operator=(HotValue const&) = delete;
+
+  // create replicas for an option. value must point to the destination
+  // variable of the option's parameter. the number of replicas defaults to
+  // the number of hardware threads, and is rounded up to a power of two
+  HotValue(ProgramOptions* options, std::string const& name, T const* value,
+           size_t replicas = ThreadPool::defaultConcurrency())
+      : _options(options),
+        _value(value),
+        _option(options->findOption(name)),
+        _profiler(options->readProfiler()),
+        _replicas(roundUp(replicas)),
+        _buffer(new char[(_replicas + 1) * SlotSize]),
+        _slots(nullptr) {
+    // operator new does not respect the alignment of Slot before C++17,
+    // so align the slots manually
+    uintptr_t const address = reinterpret_cast<uintptr_t>(_buffer.get());
+    _slots = reinterpret_cast<Slot*>((address + SlotSize - 1) &
+                                     ~static_cast<uintptr_t>(SlotSize - 1));
+    for (size_t i = 0; i < _replicas; ++i) {
+      new (&_slots[i]) Slot();
+    }
+
+    store(*_value);
+    _listener = options->addChangeListener(name, [this]() { store(*_value); });
+  }
+
+  ~HotValue() { _options->removeChangeListener(_listener); }
+
+  // read the value from the calling thread's replica
+  T get(ReadSite const& site = ReadSite()) const {
+    if (_profiler != nullptr) {
+      _profiler->record(*_option, site);
+    }
+    return _slots[threadIndex() & (_replicas - 1)].value.load(
+        std::memory_order_acquire);
+  }
+
+  // number of replicas
+  size_t replicas() const { return _replicas; }
+
+ private:
+  // a single replica, padded to a full cache line
+  struct alignas(SlotSize) Slot {
+    std::atomic<T> value;
+    char padding[SlotSize - sizeof(std::atomic<T>)];
+  };
+
+  static_assert(sizeof(std::atomic<T>) < SlotSize,
+                "value type is too big for a hot value");
+
+  // update all replicas. readers may see the old value in some replicas
+  // until this has returned
+  void store(T value) {
+    for (size_t i = 0; i < _replicas; ++i) {
+      _slots[i].value.store(value, std::memory_order_release);
+    }
+  }
+
+  // round up to the next power of two
+  static size_t roundUp(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+      result <<= 1;
+    }
+    return result;
+  }
+
+  // get the index of the calling thread. indexes are handed out round-robin
+  // when a thread reads a hot value for the first time
+  static size_t threadIndex() {
+    // constant-initialized, so accessing it does not need a guard
+    static thread_local size_t index = SIZE_MAX;
+    if (index == SIZE_MAX) {
+      static std::atomic<size_t> next(0);
+      index = next.fetch_add(1, std::memory_order_relaxed);
+    }
+    return index;
+  }
+
+  ProgramOptions* _options;
+  // listener updating the replicas
+  ProgramOptions::ListenerHandle _listener;
+  // destination variable of the option's parameter
+  T const* _value;
+  // the option
+  Option const* _option;
+  // read profiler, nullptr if none
+  ReadProfiler* _profiler;
+  // number of replicas
+  size_t const _replicas;
+  // memory for the replicas
+  std::unique_ptr<char[]> _buffer;
+  // the replicas, aligned to cache lines inside _buffer
+  Slot* _slots;
+};
+}
+}
+
+#endif
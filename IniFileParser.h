@@ -2,95 +2,1159 @@
 #define ARANGODB_PROGRAM_OPTIONS_INI_FILE_PARSER_H 1
 
 #include <string>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <future>
 #include <iostream>
-#include <regex>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+#include "IniScanner.h"
 #include "ProgramOptions.h"
+#include "ResponseFile.h"
+#include "ThreadPool.h"
+#include "Token.h"
 
 namespace arangodb {
 namespace options {
 
+// parser for ini-style config files. besides sections and assignments,
+// config files can contain the directives
+// - "@include <file>", which parses another config file at this point
+// - "@include-dir <directory>", which parses all files with the extensions
+//   ".conf" and ".ini" in the directory, in the order of their names
+// - "@clear <option>", which removes all values of a vector option,
+//   including its default values. the option name is resolved like the
+//   names of assignments
+// relative names are resolved against the directory of the including file
 class IniFileParser {
+ private:
+  // the types of lines in an ini file
+  enum class LineType {
+    Comment,
+    Section,
+    Assignment,
+    Include,
+    IncludeDirectory,
+    Clear,
+    Invalid
+  };
+
+  // an assignment, include or clear directive found in a config file, or an
+  // invalid line
+  struct Assignment {
+    Assignment(size_t line, LineType type) : line(line), type(type) {}
+
+    // line number, relative to the start of the chunk. cached assignments
+    // have absolute line numbers
+    size_t line;
+    LineType type;
+    std::string option;
+    // the value, or the file or directory name of an include directive
+    std::string value;
+  };
+
  public:
-  explicit IniFileParser(ProgramOptions* options) : _options(options) {
-    // a line with just comments, e.g. #... or ;...
-    _matchers.comment = std::regex("^[ \t]*([#;].*)?$",
-                                   std::regex::nosubs | std::regex::ECMAScript);
-    // a line that starts a section, e.g. [server]
-    _matchers.section = std::regex("^[ \t]*\\[([-_A-Za-z0-9]*)\\][ \t]*$",
-                                   std::regex::ECMAScript);
-    // a line that assigns a value to a named variable
-    _matchers.assignment = std::regex(
-        "^[ \t]*(([-_A-Za-z0-9]*\\.)?[-_A-Za-z0-9]*)[ \t]*=[ \t]*(.*)?[ \t]*$",
-        std::regex::ECMAScript);
+  // cache of parsed config files, for reloading configurations that are
+  // split into many files. the assignments found in a file are stored
+  // together with the identity of the file (device, inode, size and
+  // modification time). a file is only parsed again if its identity has
+  // changed, otherwise its assignments are replayed, which gives the same
+  // results as parsing it. a cache can be shared by multiple parsers, but
+  // not by parsers running concurrently
+  class Cache {
+   public:
+    Cache() : _hits(0), _misses(0) {}
+
+    // no need to copy this
+    Cache(Cache const&) = delete;
+    Cache& operator=(Cache const&) = delete;
+
+    // number of cached files
+    size_t size() const { return _entries.size(); }
+
+    // number of times cached assignments were replayed
+    size_t hits() const { return _hits; }
+
+    // number of times a file was parsed and added to the cache
+    size_t misses() const { return _misses; }
+
+    // remove all cached files
+    void clear() { _entries.clear(); }
+
+   private:
+    friend class IniFileParser;
+
+    // identity of a file. if any of these change, the file is parsed again
+    struct Identity {
+      Identity() : device(0), inode(0), size(0), mtime(0) {}
+
+      bool operator==(Identity const& other) const {
+        return device == other.device && inode == other.inode &&
+               size == other.size && mtime == other.mtime;
+      }
+
+      // get the identity of a file. returns false if the file does not
+      // exist
+      bool load(std::string const& path) {
+#ifdef _WIN32
+        struct _stat64 st;
+        if (_stat64(path.c_str(), &st) != 0) {
+          return false;
+        }
+        mtime = static_cast<int64_t>(st.st_mtime) * 1000000000;
+#else
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) {
+          return false;
+        }
+#ifdef __APPLE__
+        mtime = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 +
+                st.st_mtimespec.tv_nsec;
+#else
+        mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 +
+                st.st_mtim.tv_nsec;
+#endif
+#endif
+        device = static_cast<uint64_t>(st.st_dev);
+        inode = static_cast<uint64_t>(st.st_ino);
+        size = static_cast<uint64_t>(st.st_size);
+        return true;
+      }
+
+      uint64_t device;
+      uint64_t inode;
+      uint64_t size;
+      // modification time, in nanoseconds
+      int64_t mtime;
+    };
+
+    // a cached file
+    struct Entry {
+      Identity identity;
+      // all assignments and include directives, with absolute line numbers
+      std::vector<Assignment> assignments;
+    };
+
+    // find the assignments of a file, by canonical path. returns a nullptr
+    // if the file is not cached or has changed
+    std::vector<Assignment> const* find(std::string const& path,
+                                        Identity const& identity) const {
+      auto it = _entries.find(path);
+      if (it == _entries.end() || !((*it).second.identity == identity)) {
+        return nullptr;
+      }
+      return &(*it).second.assignments;
+    }
+
+    // store the assignments of a file, by canonical path
+    std::vector<Assignment> const& store(
+        std::string const& path, Identity const& identity,
+        std::vector<Assignment>&& assignments) {
+      Entry& entry = _entries[path];
+      entry.identity = identity;
+      entry.assignments = std::move(assignments);
+      return entry.assignments;
+    }
+
+    // cached files, by canonical path
+    std::unordered_map<std::string, Entry> _entries;
+    size_t _hits;
+    size_t _misses;
+  };
+
+  explicit IniFileParser(ProgramOptions* options)
+      : _options(options), _cache(nullptr), _failed(false) {}
+
+  // use a cache for parsing config files by name, or stop using it by
+  // passing a nullptr. the cache must outlive the parser
+  void setCache(Cache* cache) { _cache = cache; }
+
+  // names of all config files the parser has parsed or tried to parse,
+  // including included files, in the order they were first parsed
+  std::vector<std::string> const& files() const { return _files; }
+
+  // names of all directories included via "@include-dir"
+  std::vector<std::string> const& directories() const { return _directories; }
+
+  // whether or not a file in a directory is included by "@include-dir",
+  // i.e. is not hidden and has the extension ".conf" or ".ini"
+  static bool isConfigFile(std::string const& name) {
+    return !name.empty() && name[0] != '.' &&
+           (hasSuffix(name, ".conf") || hasSuffix(name, ".ini"));
   }
 
+  // lazy token stream over a config file or stream. each call to next()
+  // interprets lines until the next assignment is found, without applying
+  // it. the input is read in chunks, so only one chunk is held in memory
+  class Tokenizer {
+   public:
+    // tokenize a config file
+    explicit Tokenizer(std::string const& filename)
+        : Tokenizer(filename, std::vector<std::string>()) {}
+
+    // tokenize a stream, e.g. std::cin. name is used in token locations
+    Tokenizer(std::istream& stream, std::string const& name)
+        : _stream(&stream),
+          _location(SourceType::ConfigFile, name, 0),
+          _consumed(0),
+          _next(0),
+          _end(false),
+          _failed(false) {}
+
+    // produce the next token. returns false if there are no more tokens
+    // the tokens of included files are produced in place of the include
+    // directives. errors are produced as Error tokens, after which
+    // tokenizing continues with the next line (or the next included file),
+    // so that all errors are found. only a file that cannot be opened ends
+    // its token stream, as there is nothing more to tokenize
+    bool next(Token& token) {
+      while (true) {
+        if (_nested != nullptr) {
+          if (_nested->next(token)) {
+            return true;
+          }
+          _nested.reset();
+        }
+
+        if (!_pending.empty()) {
+          // tokenize the next included file
+          std::string const name = _pending.back();
+          _pending.pop_back();
+          std::string const path = ResponseFile::canonicalPath(name);
+          if (!path.empty() && std::find(_includes.begin(), _includes.end(),
+                                         path) != _includes.end()) {
+            token.type = Token::Type::Error;
+            token.option.clear();
+            token.value = "recursive inclusion of file '" + name + "'";
+            token.location = _includeLocation;
+            return true;
+          }
+          _nested.reset(new Tokenizer(name, _includes));
+          continue;
+        }
+
+        if (_next < _lines.size()) {
+          IniLine const& line = _lines[_next++];
+          ++_location.position;
+
+          LineType const type = interpretLine(
+              _buffer.data() + line.begin, line.end - line.begin,
+              line.equals == std::string::npos ? std::string::npos
+                                               : line.equals - line.begin,
+              line.carriageReturn, _currentSection, token.option, token.value);
+
+          if (type == LineType::Comment || type == LineType::Section) {
+            continue;
+          }
+
+          token.location = _location;
+          if (type == LineType::Include ||
+              type == LineType::IncludeDirectory) {
+            std::vector<std::string> files;
+            if (!includedFiles(type, token.value, _location.name, files)) {
+              token.type = Token::Type::Error;
+              token.option.clear();
+              token.value = "unable to open directory '" + token.value + "'";
+              return true;
+            }
+            // files are taken from the back
+            _pending.assign(files.rbegin(), files.rend());
+            _includeLocation = _location;
+            continue;
+          }
+          if (type == LineType::Assignment) {
+            token.type = Token::Type::Option;
+          } else if (type == LineType::Clear) {
+            token.type = Token::Type::Clear;
+          } else {
+            token.type = Token::Type::Error;
+            token.option.clear();
+            token.value = "unknown line type";
+          }
+          return true;
+        }
+
+        if (_end || _failed) {
+          return false;
+        }
+
+        if (_stream == nullptr) {
+          token.type = Token::Type::Error;
+          token.option.clear();
+          token.value = "unable to open file";
+          token.location = _location;
+          _failed = true;
+          return true;
+        }
+
+        refill();
+      }
+    }
+
+   private:
+    // tokenize a config file included from the files in includes
+    Tokenizer(std::string const& filename,
+              std::vector<std::string> const& includes)
+        : _file(new std::ifstream(filename, std::ifstream::in)),
+          _stream(_file->is_open() ? _file.get() : nullptr),
+          _location(SourceType::ConfigFile, filename, 0),
+          _consumed(0),
+          _next(0),
+          _end(false),
+          _failed(false),
+          _includes(includes) {
+      _includes.emplace_back(ResponseFile::canonicalPath(filename));
+    }
+
+    // read the next chunk of input and find the lines in it
+    void refill() {
+      // keep the incomplete trailing line of the previous chunk
+      _buffer.erase(0, _consumed);
+      _lines.clear();
+      _next = 0;
+
+      size_t const offset = _buffer.size();
+      _buffer.resize(offset + 65536);
+      _stream->read(&_buffer[offset], 65536);
+      _buffer.resize(offset + static_cast<size_t>(_stream->gcount()));
+
+      _consumed = IniScanner::scan(_buffer.data(), _buffer.size(),
+                                   [this](IniLine const& line) -> bool {
+                                     _lines.push_back(line);
+                                     return true;
+                                   });
+
+      if (!_stream->good()) {
+        // the input is always followed by one final line, which is empty if
+        // the input ends with a newline
+        IniLine line;
+        line.begin = _consumed;
+        line.end = _buffer.size();
+        line.equals = _buffer.find('=', _consumed);
+        line.carriageReturn =
+            _buffer.find('\r', _consumed) != std::string::npos;
+        _lines.push_back(line);
+        _consumed = _buffer.size();
+        _end = true;
+      }
+    }
+
+    // the file being tokenized, if the tokenizer was created for a file
+    std::unique_ptr<std::ifstream> _file;
+    // the stream being tokenized, nullptr if the file could not be opened
+    std::istream* _stream;
+    // location of the line currently being tokenized
+    SourceLocation _location;
+    // name of the section the tokenizer is currently in
+    std::string _currentSection;
+    // current chunk of input, starting with the incomplete trailing line of
+    // the previous chunk
+    std::string _buffer;
+    // number of bytes of _buffer that belong to complete lines
+    size_t _consumed;
+    // complete lines of the current chunk
+    std::vector<IniLine> _lines;
+    // index of the next line to tokenize
+    size_t _next;
+    // whether or not the end of the input was reached
+    bool _end;
+    // whether or not the error token for an input that could not be opened
+    // was produced
+    bool _failed;
+    // canonical paths of this file and all files including it
+    std::vector<std::string> _includes;
+    // included files that have not been tokenized yet, last one first
+    std::vector<std::string> _pending;
+    // location of the include directive for _pending
+    SourceLocation _includeLocation;
+    // tokenizer for the included file currently being tokenized
+    std::unique_ptr<Tokenizer> _nested;
+  };
+
   // parse a config file. returns true if all is well, false otherwise
   // errors that occur during parse are reported to _options
+  // if a cache is set, the file is only parsed if it is not in the cache
+  // or has changed since it was cached
   bool parse(std::string const& filename) {
-    std::ifstream ifs(filename, std::ifstream::in);
+    std::string const path = ResponseFile::canonicalPath(filename);
+    if (!path.empty() && std::find(_includes.begin(), _includes.end(),
+                                   path) != _includes.end()) {
+      return _options->fail("recursive inclusion of file '" + filename + "'");
+    }
 
-    if (!ifs.is_open()) {
-      return _options->fail("unable to open file");
+    addName(_files, filename);
+    _includes.emplace_back(path);
+    bool const result = parseFile(filename, path);
+    _includes.pop_back();
+    return result;
+  }
+
+  // parse config data from a stream, e.g. std::cin. name is used in error
+  // messages. returns true if all is well, false otherwise
+  bool parse(std::istream& stream, std::string const& name) {
+    begin(name);
+
+    char buffer[65536];
+    while (stream.good()) {
+      stream.read(buffer, sizeof(buffer));
+      if (!feed(buffer, static_cast<size_t>(stream.gcount()))) {
+        return false;
+      }
     }
 
-    std::string currentSection;
-    size_t lineNumber = 0;
+    return finish();
+  }
 
-    while (ifs.good()) {
-      std::string line;
-      ++lineNumber;
+  // parse multiple config files, as if they were parsed one after the other
+  // in the given order. the files are read and tokenized in parallel on a
+  // pool with the given number of threads, and large files are additionally
+  // split at section boundaries. the resulting values are then applied in
+  // file and line order, so values, touched options and error messages are
+  // the same as for sequential parsing
+  bool parse(std::vector<std::string> const& filenames,
+             size_t concurrency = ThreadPool::defaultConcurrency()) {
+    size_t const n = filenames.size();
+    std::vector<Input> inputs(n);
+    std::vector<Chunk> chunks;
+    Cache const* cache = _cache;
 
-      std::getline(ifs, line);
+    {
+      ThreadPool pool(concurrency);
 
-      if (std::regex_match(line, _matchers.comment)) {
-        // skip over comments
-        continue;
+      // read all files that are not cached
+      pool.run(n, [&filenames, &inputs, cache](size_t i) {
+        inputs[i].path = ResponseFile::canonicalPath(filenames[i]);
+        if (cache != nullptr && !inputs[i].path.empty() &&
+            inputs[i].identity.load(inputs[i].path)) {
+          inputs[i].identified = true;
+          inputs[i].cached = cache->find(inputs[i].path, inputs[i].identity);
+          if (inputs[i].cached != nullptr) {
+            inputs[i].opened = true;
+            return;
+          }
+        }
+
+        std::ifstream ifs(filenames[i], std::ifstream::in);
+        if (!ifs.is_open()) {
+          return;
+        }
+        inputs[i].opened = true;
+
+        char buffer[65536];
+        while (ifs.good()) {
+          ifs.read(buffer, sizeof(buffer));
+          inputs[i].content.append(buffer,
+                                   static_cast<size_t>(ifs.gcount()));
+        }
+      });
+
+      // split files into chunks. a chunk boundary is only placed in front of
+      // a line starting with '['. such a line is either a section start, or
+      // an invalid line, so no chunk depends on the section of a previous one
+      for (size_t i = 0; i < n; ++i) {
+        if (!inputs[i].opened || inputs[i].cached != nullptr) {
+          continue;
+        }
+        std::string const& content = inputs[i].content;
+        size_t begin = 0;
+        while (true) {
+          size_t end = std::string::npos;
+          if (content.size() - begin > SplitSize) {
+            end = content.find("\n[", begin + SplitSize - 1);
+          }
+          if (end == std::string::npos) {
+            chunks.emplace_back(i, begin, content.size(), true);
+            break;
+          }
+          chunks.emplace_back(i, begin, end + 1, false);
+          begin = end + 1;
+        }
       }
 
-      // set context for parsing (used in error messages)
-      _options->setContext("config file '" + filename + "', line #" +
-                           std::to_string(lineNumber));
+      // tokenize all chunks
+      pool.run(chunks.size(), [&inputs, &chunks](size_t i) {
+        tokenizeChunk(inputs[chunks[i].file].content, chunks[i]);
+      });
+    }
+
+    // apply the values in order
+    auto chunk = chunks.begin();
+    for (size_t i = 0; i < n; ++i) {
+      if (!inputs[i].opened) {
+        return _options->fail("unable to open file");
+      }
 
-      std::smatch match;
-      if (std::regex_match(line, match, _matchers.section)) {
-        // found section
-        currentSection = match[1].str();
-      } else if (std::regex_match(line, match, _matchers.assignment)) {
-        // found assignment
-        std::string option;
-        std::string value(match[3].str());
+      addName(_files, filenames[i]);
+      _includes.emplace_back(inputs[i].path);
+      bool result = true;
 
-        if (currentSection.empty() || !match[2].str().empty()) {
-          // use option as specified
-          option = match[1].str();
+      if (inputs[i].cached != nullptr) {
+        ++_cache->_hits;
+        result = apply(*inputs[i].cached, filenames[i], 0);
+      } else {
+        std::vector<Assignment> assignments;
+        size_t lineOffset = 0;
+        for (; chunk != chunks.end() && (*chunk).file == i; ++chunk) {
+          for (auto& it : (*chunk).assignments) {
+            it.line += lineOffset;
+            assignments.emplace_back(std::move(it));
+          }
+          lineOffset += (*chunk).lines;
+        }
+        if (_cache != nullptr && inputs[i].identified) {
+          ++_cache->_misses;
+          result = apply(_cache->store(inputs[i].path, inputs[i].identity,
+                                       std::move(assignments)),
+                         filenames[i], 0);
         } else {
-          // use option prefixed with current section
-          option = currentSection + "." + match[1].str();
+          result = apply(assignments, filenames[i], 0);
         }
+      }
 
-        if (!_options->setValue(option, value)) {
-          return false;
+      _includes.pop_back();
+      if (!result) {
+        return false;
+      }
+    }
+
+    // all is well
+    return true;
+  }
+
+  // start parsing a config file on a background thread. the returned future
+  // yields the result of parse(). the ProgramOptions instance and the
+  // option destinations must not be used until the future is ready, and
+  // the parser must stay alive until then
+  std::future<bool> parseAsync(std::string const& filename) {
+    return std::async(std::launch::async,
+                      [this, filename]() { return parse(filename); });
+  }
+
+  // start parsing multiple config files on a background thread. see the
+  // single-file version of parseAsync() for the rules to follow
+  std::future<bool> parseAsync(
+      std::vector<std::string> const& filenames,
+      size_t concurrency = ThreadPool::defaultConcurrency()) {
+    return std::async(std::launch::async, [this, filenames, concurrency]() {
+      return parse(filenames, concurrency);
+    });
+  }
+
+  // start incremental parsing of a new input. name is used in error messages
+  void begin(std::string const& name) {
+    _location = SourceLocation(SourceType::ConfigFile, name, 0);
+    _currentSection.clear();
+    _partial.clear();
+    _failed = false;
+  }
+
+  // feed a chunk of input into the parser. chunks can be split anywhere,
+  // values are applied as soon as the line containing them is complete.
+  // only the incomplete trailing line of a chunk is buffered until the next
+  // call. returns false if parsing has failed
+  bool feed(char const* data, size_t length) {
+    if (_failed) {
+      return false;
+    }
+
+    if (!_partial.empty()) {
+      // complete the line left over from the previous chunk first
+      char const* newline =
+          static_cast<char const*>(memchr(data, '\n', length));
+      if (newline == nullptr) {
+        _partial.append(data, length);
+        return true;
+      }
+      size_t const consumed = static_cast<size_t>(newline - data);
+      _partial.append(data, consumed);
+      if (!parseLine(_partial.data(), _partial.size())) {
+        return false;
+      }
+      _partial.clear();
+      data += consumed + 1;
+      length -= consumed + 1;
+    }
+
+    size_t const rest = IniScanner::scan(
+        data, length, [this, data](IniLine const& line) -> bool {
+          return parseLine(data + line.begin, line.end - line.begin,
+                           line.equals == std::string::npos
+                               ? std::string::npos
+                               : line.equals - line.begin,
+                           line.carriageReturn);
+        });
+
+    if (rest == std::string::npos) {
+      return false;
+    }
+
+    _partial.append(data + rest, length - rest);
+    return true;
+  }
+
+  // signal the end of the input and parse the final line. returns true if
+  // all is well, false otherwise
+  bool finish() {
+    if (_failed) {
+      return false;
+    }
+
+    // the input is always followed by one final line, which is empty if the
+    // input ends with a newline
+    bool result = parseLine(_partial.data(), _partial.size());
+    _partial.clear();
+    return result;
+  }
+
+ private:
+  // contents of a config file read by the multi-file parser
+  struct Input {
+    Input() : opened(false), identified(false), cached(nullptr) {}
+
+    std::string content;
+    // canonical path of the file
+    std::string path;
+    // identity of the file, if it was determined for the cache
+    Cache::Identity identity;
+    bool opened;
+    bool identified;
+    // the cached assignments of the file, nullptr if it was read
+    std::vector<Assignment> const* cached;
+  };
+
+  // a part of a config file that is tokenized independently
+  struct Chunk {
+    Chunk(size_t file, size_t begin, size_t end, bool last)
+        : file(file), begin(begin), end(end), last(last), lines(0) {}
+
+    // index of the file the chunk belongs to
+    size_t file;
+    // byte range of the chunk inside the file
+    size_t begin;
+    size_t end;
+    // whether or not this is the last chunk of the file
+    bool last;
+    // number of lines in the chunk
+    size_t lines;
+    // the assignments found, up to and including the first invalid line
+    std::vector<Assignment> assignments;
+  };
+
+  // files larger than this are split into multiple chunks
+  static size_t const SplitSize = 1024 * 1024;
+
+  // tokenize a chunk of a config file
+  static void tokenizeChunk(std::string const& content, Chunk& chunk) {
+    std::string currentSection;
+    std::string option;
+    std::string value;
+
+    auto process = [&chunk, &currentSection, &option, &value](
+        char const* line, size_t length, size_t equals,
+        bool carriageReturn) -> bool {
+      ++chunk.lines;
+      LineType const type = interpretLine(line, length, equals, carriageReturn,
+                                          currentSection, option, value);
+      if (type == LineType::Assignment || type == LineType::Include ||
+          type == LineType::IncludeDirectory || type == LineType::Clear) {
+        chunk.assignments.emplace_back(chunk.lines, type);
+        chunk.assignments.back().option.swap(option);
+        chunk.assignments.back().value.swap(value);
+      } else if (type == LineType::Invalid) {
+        // values after an invalid line are never applied
+        chunk.assignments.emplace_back(chunk.lines, type);
+        return false;
+      }
+      return true;
+    };
+
+    char const* data = content.data() + chunk.begin;
+    size_t const length = chunk.end - chunk.begin;
+
+    size_t const rest = IniScanner::scan(
+        data, length, [&process, data](IniLine const& line) -> bool {
+          return process(data + line.begin, line.end - line.begin,
+                         line.equals == std::string::npos
+                             ? std::string::npos
+                             : line.equals - line.begin,
+                         line.carriageReturn);
+        });
+
+    if (rest != std::string::npos && chunk.last) {
+      // the final line of the file
+      char const* last = data + rest;
+      char const* equals =
+          static_cast<char const*>(memchr(last, '=', length - rest));
+      process(last, length - rest,
+              equals == nullptr ? std::string::npos
+                                : static_cast<size_t>(equals - last),
+              memchr(last, '\r', length - rest) != nullptr);
+    }
+  }
+
+  // whether or not a character is a blank
+  static bool isBlank(char c) { return c == ' ' || c == '\t'; }
+
+  // whether or not a character may be used in section and option names
+  static bool isNameCharacter(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           (c >= '0' && c <= '9') || c == '-' || c == '_';
+  }
+
+  // parse a single line. equals is the position of the first '=' in the
+  // line, or std::string::npos if there is none
+  bool parseLine(char const* line, size_t length, size_t equals,
+                 bool carriageReturn) {
+    ++_location.position;
+
+    LineType const type = interpretLine(line, length, equals, carriageReturn,
+                                        _currentSection, _option, _value);
+
+    if (type == LineType::Comment) {
+      // skip over comments
+      return true;
+    }
+
+    // set location for parsing (used in error messages)
+    _options->setLocation(_location);
+
+    if (type == LineType::Section) {
+      return true;
+    }
+
+    if (type == LineType::Assignment) {
+      if (!_options->setValue(_option, _value)) {
+        _failed = true;
+        return false;
+      }
+      return true;
+    }
+
+    if (type == LineType::Clear) {
+      if (!_options->clearValue(_option)) {
+        _failed = true;
+        return false;
+      }
+      return true;
+    }
+
+    if (type == LineType::Include || type == LineType::IncludeDirectory) {
+      if (!include(type, _value, _location.name)) {
+        _failed = true;
+        return false;
+      }
+      return true;
+    }
+
+    // unknown type of line. cannot handle it
+    _failed = true;
+    return _options->fail("unknown line type");
+  }
+
+  // skip over an option name, optionally qualified with a section name.
+  // returns whether or not the name is qualified
+  static bool skipName(char const*& p, char const* end) {
+    while (p < end && isNameCharacter(*p)) {
+      ++p;
+    }
+    if (p < end && *p == '.') {
+      ++p;
+      while (p < end && isNameCharacter(*p)) {
+        ++p;
+      }
+      return true;
+    }
+    return false;
+  }
+
+  // build the full name of an option found in the current section
+  static void optionName(std::string const& currentSection, char const* name,
+                         char const* nameEnd, bool qualified,
+                         std::string& option) {
+    option.clear();
+    if (!currentSection.empty() && !qualified) {
+      // use option prefixed with current section
+      option.append(currentSection).push_back('.');
+    }
+    option.append(name, nameEnd - name);
+  }
+
+  // interpret a single line without applying it. equals is the position of
+  // the first '=' in the line, or std::string::npos if there is none. the
+  // recognized line types are:
+  // - comments and empty lines, e.g. #... or ;...
+  // - section starts, e.g. [server]. currentSection is updated for these
+  // - assignments of a value to a named variable, e.g. endpoint = foo. the
+  //   full option name and the value are returned in option and value
+  // - include directives, e.g. @include foo.conf. the file or directory
+  //   name is returned in value
+  // - clear directives, e.g. @clear endpoints. the full option name is
+  //   returned in option
+  static LineType interpretLine(char const* line, size_t length, size_t equals,
+                                bool carriageReturn,
+                                std::string& currentSection,
+                                std::string& option, std::string& value) {
+    char const* p = line;
+    char const* end = line + length;
+
+    while (p < end && isBlank(*p)) {
+      ++p;
+    }
+
+    if (carriageReturn) {
+      // none of the line types allows a '\r'
+      return LineType::Invalid;
+    }
+
+    if (p == end || *p == '#' || *p == ';') {
+      return LineType::Comment;
+    }
+
+    if (*p == '@') {
+      char const* name = ++p;
+      while (p < end && isNameCharacter(*p)) {
+        ++p;
+      }
+      size_t const length = static_cast<size_t>(p - name);
+      LineType type = LineType::Invalid;
+      if (length == 7 && memcmp(name, "include", 7) == 0) {
+        type = LineType::Include;
+      } else if (length == 11 && memcmp(name, "include-dir", 11) == 0) {
+        type = LineType::IncludeDirectory;
+      } else if (length == 5 && memcmp(name, "clear", 5) == 0) {
+        type = LineType::Clear;
+      }
+      if (type != LineType::Invalid && p < end && isBlank(*p)) {
+        while (p < end && isBlank(*p)) {
+          ++p;
         }
-      } else {
+        while (end > p && isBlank(*(end - 1))) {
+          --end;
+        }
+        if (type == LineType::Clear) {
+          char const* name = p;
+          bool const qualified = skipName(p, end);
+          if (p > name && p == end) {
+            optionName(currentSection, name, p, qualified, option);
+            value.clear();
+            return type;
+          }
+        } else if (p < end) {
+          option.clear();
+          value.assign(p, end - p);
+          return type;
+        }
+      }
+      return LineType::Invalid;
+    }
+
+    if (*p == '[') {
+      char const* name = ++p;
+      while (p < end && isNameCharacter(*p)) {
+        ++p;
+      }
+      if (p < end && *p == ']') {
+        char const* nameEnd = p++;
+        while (p < end && isBlank(*p)) {
+          ++p;
+        }
+        if (p == end) {
+          currentSection.assign(name, nameEnd - name);
+          return LineType::Section;
+        }
+      }
+    } else if (equals != std::string::npos) {
+      char const* name = p;
+      bool const qualified = skipName(p, end);
+      char const* nameEnd = p;
+      while (p < end && isBlank(*p)) {
+        ++p;
+      }
+      if (p == line + equals) {
+        ++p;
+        while (p < end && isBlank(*p)) {
+          ++p;
+        }
+
+        optionName(currentSection, name, nameEnd, qualified, option);
+        value.assign(p, end - p);
+        return LineType::Assignment;
+      }
+    }
+
+    return LineType::Invalid;
+  }
+
+  // parse a config file with the given canonical path
+  bool parseFile(std::string const& filename, std::string const& path) {
+    Cache::Identity identity;
+    if (_cache != nullptr && !path.empty() && identity.load(path)) {
+      std::vector<Assignment> const* cached = _cache->find(path, identity);
+      if (cached != nullptr) {
+        ++_cache->_hits;
+        return apply(*cached, filename, 0);
+      }
+
+      std::ifstream ifs(filename, std::ifstream::in);
+      if (!ifs.is_open()) {
+        return _options->fail("unable to open file");
+      }
+      std::string content;
+      char buffer[65536];
+      while (ifs.good()) {
+        ifs.read(buffer, sizeof(buffer));
+        content.append(buffer, static_cast<size_t>(ifs.gcount()));
+      }
+
+      Chunk chunk(0, 0, content.size(), true);
+      tokenizeChunk(content, chunk);
+      ++_cache->_misses;
+      return apply(_cache->store(path, identity, std::move(chunk.assignments)),
+                   filename, 0);
+    }
+
+    std::ifstream ifs(filename, std::ifstream::in);
+
+    if (!ifs.is_open()) {
+      return _options->fail("unable to open file");
+    }
+
+    if (_options->validationConcurrency() > 1) {
+      // values are validated concurrently, so all assignments need to be
+      // known up front
+      std::string content;
+      char buffer[65536];
+      while (ifs.good()) {
+        ifs.read(buffer, sizeof(buffer));
+        content.append(buffer, static_cast<size_t>(ifs.gcount()));
+      }
+
+      Chunk chunk(0, 0, content.size(), true);
+      tokenizeChunk(content, chunk);
+      return apply(chunk.assignments, filename, 0);
+    }
+
+    return parse(ifs, filename);
+  }
+
+  // apply assignments found in a config file, in order
+  bool apply(std::vector<Assignment> const& assignments,
+             std::string const& filename, size_t lineOffset) {
+    if (_options->validationConcurrency() > 1) {
+      return applyBatches(assignments, filename, lineOffset);
+    }
+
+    SourceLocation location(SourceType::ConfigFile, filename, 0);
+    for (auto const& it : assignments) {
+      // set location for parsing (used in error messages)
+      location.position = lineOffset + it.line;
+      _options->setLocation(location);
+
+      switch (it.type) {
+        case LineType::Assignment:
+          if (!_options->setValue(it.option, it.value)) {
+            return false;
+          }
+          break;
+        case LineType::Clear:
+          if (!_options->clearValue(it.option)) {
+            return false;
+          }
+          break;
+        case LineType::Include:
+        case LineType::IncludeDirectory:
+          if (!include(it.type, it.value, filename)) {
+            return false;
+          }
+          break;
+        default:
+          // unknown type of line. cannot handle it
+          return _options->fail("unknown line type");
+      }
+    }
+    return true;
+  }
+
+  // apply assignments found in a config file, in order, in batches whose
+  // values are validated concurrently. a batch ends at each include
+  // directive or invalid line
+  bool applyBatches(std::vector<Assignment> const& assignments,
+                    std::string const& filename, size_t lineOffset) {
+    std::vector<Token> batch;
+    Token token;
+    token.location = SourceLocation(SourceType::ConfigFile, filename, 0);
+
+    for (auto const& it : assignments) {
+      token.location.position = lineOffset + it.line;
+      if (it.type == LineType::Assignment || it.type == LineType::Clear) {
+        token.type = it.type == LineType::Assignment ? Token::Type::Option
+                                                     : Token::Type::Clear;
+        token.option = it.option;
+        token.value = it.value;
+        batch.emplace_back(token);
+        continue;
+      }
+
+      if (!_options->apply(batch)) {
+        return false;
+      }
+      batch.clear();
+
+      // set location for parsing (used in error messages)
+      _options->setLocation(token.location);
+      if (it.type != LineType::Include &&
+          it.type != LineType::IncludeDirectory) {
         // unknown type of line. cannot handle it
         return _options->fail("unknown line type");
       }
+      if (!include(it.type, it.value, filename)) {
+        return false;
+      }
     }
 
-    // all is well
+    return _options->apply(batch);
+  }
+
+  // parse the files included by an include directive in the file parent
+  bool include(LineType type, std::string const& name,
+               std::string const& parent) {
+    if (type == LineType::IncludeDirectory) {
+      addName(_directories, ResponseFile::resolve(name, parent));
+    }
+
+    std::vector<std::string> files;
+    if (!includedFiles(type, name, parent, files)) {
+      return _options->fail("unable to open directory '" + name + "'");
+    }
+
+    // parsing another file replaces the state of the current one
+    SourceLocation const location = _location;
+    std::string const section = _currentSection;
+    for (auto const& it : files) {
+      if (!parse(it)) {
+        return false;
+      }
+    }
+    _location = location;
+    _currentSection = section;
     return true;
   }
 
- private:
-  ProgramOptions* _options;
+  // get the names of the files included by an include directive in the file
+  // parent. returns false if an included directory cannot be read
+  static bool includedFiles(LineType type, std::string const& name,
+                            std::string const& parent,
+                            std::vector<std::string>& files) {
+    std::string const resolved = ResponseFile::resolve(name, parent);
+    if (type == LineType::Include) {
+      files.emplace_back(resolved);
+      return true;
+    }
+    return listDirectory(resolved, files);
+  }
+
+  // get the names of all config files in a directory, sorted by name.
+  // returns false if the directory cannot be read
+  static bool listDirectory(std::string const& directory,
+                            std::vector<std::string>& files) {
+    std::vector<std::string> names;
+#ifdef _WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE handle = FindFirstFileA((directory + "\\*").c_str(), &data);
+    if (handle == INVALID_HANDLE_VALUE) {
+      return false;
+    }
+    do {
+      if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0) {
+        names.emplace_back(data.cFileName);
+      }
+    } while (FindNextFileA(handle, &data));
+    FindClose(handle);
+    char const separator = '\\';
+#else
+    DIR* dir = opendir(directory.c_str());
+    if (dir == nullptr) {
+      return false;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+      names.emplace_back(entry->d_name);
+    }
+    closedir(dir);
+    char const separator = '/';
+#endif
 
-  struct {
-    std::regex comment;
-    std::regex section;
-    std::regex assignment;
-  } _matchers;
+    std::sort(names.begin(), names.end());
+    for (auto const& it : names) {
+      if (!isConfigFile(it)) {
+        continue;
+      }
+      if (!directory.empty() && directory.back() != '/' &&
+          directory.back() != separator) {
+        files.emplace_back(directory + separator + it);
+      } else {
+        files.emplace_back(directory + it);
+      }
+    }
+    return true;
+  }
+
+  // add a name to a list of names, unless it is already contained
+  static void addName(std::vector<std::string>& names,
+                      std::string const& name) {
+    if (std::find(names.begin(), names.end(), name) == names.end()) {
+      names.emplace_back(name);
+    }
+  }
+
+  static bool hasSuffix(std::string const& value, char const* suffix) {
+    size_t const length = strlen(suffix);
+    return value.size() > length &&
+           value.compare(value.size() - length, length, suffix) == 0;
+  }
+
+  // parse a single line whose '=' and '\r' positions are not known yet
+  bool parseLine(char const* line, size_t length) {
+    char const* equals = static_cast<char const*>(memchr(line, '=', length));
+    return parseLine(line, length,
+                     equals == nullptr ? std::string::npos
+                                       : static_cast<size_t>(equals - line),
+                     memchr(line, '\r', length) != nullptr);
+  }
+
+  ProgramOptions* _options;
+  // cache for parsed config files, nullptr if none
+  Cache* _cache;
+  // canonical paths of the config files currently being parsed, i.e. of a
+  // file and all files including it
+  std::vector<std::string> _includes;
+  // names of all parsed config files
+  std::vector<std::string> _files;
+  // names of all included directories
+  std::vector<std::string> _directories;
+  // location of the line currently being parsed
+  SourceLocation _location;
+  // name of the section the parser is currently in
+  std::string _currentSection;
+  // incomplete trailing line of the last chunk fed into the parser
+  std::string _partial;
+  // option name and value of the last assignment, reused across lines
+  std::string _option;
+  std::string _value;
+  // whether or not parsing the current input has failed
+  bool _failed;
 };
 }
 }
@@ -0,0 +1,240 @@
+#ifndef ARANGODB_PROGRAM_OPTIONS_INI_SCANNER_H
+#define ARANGODB_PROGRAM_OPTIONS_INI_SCANNER_H 1
+
+#include <string>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ARANGODB_PROGRAM_OPTIONS_SCANNER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace arangodb {
+namespace options {
+
+// a single line found by the scanner. all positions are byte offsets
+// relative to the start of the scanned input
+struct IniLine {
+  // offset of the first byte of the line
+  size_t begin;
+  // offset of the terminating '\n' (or end of input)
+  size_t end;
+  // offset of the first '=' inside the line, std::string::npos if none
+  size_t equals;
+  // whether or not the line contains a '\r' character
+  bool carriageReturn;
+};
+
+// the character classes found in a 64 byte block of input. bit i of each
+// mask is set if byte i of the block belongs to the class
+struct IniScanMasks {
+  uint64_t newlines;
+  uint64_t equals;
+  uint64_t returns;
+};
+
+// line and delimiter scanner for ini files
+// the scanner processes the input in blocks of 64 bytes and classifies
+// all bytes of a block at once, using AVX2 or SSE2 if available. the
+// kernel is selected at runtime, falling back to a scalar implementation
+class IniScanner {
+ public:
+  typedef void (*KernelType)(char const*, IniScanMasks&);
+
+  // block size processed by a single kernel invocation
+  static size_t const BlockSize = 64;
+
+  // scalar kernel, usable on all platforms
+  static void scanBlockScalar(char const* data, IniScanMasks& masks) {
+    uint64_t newlines = 0;
+    uint64_t equals = 0;
+    uint64_t returns = 0;
+    for (size_t i = 0; i < BlockSize; ++i) {
+      uint64_t const bit = uint64_t(1) << i;
+      char const c = data[i];
+      if (c == '\n') {
+        newlines |= bit;
+      } else if (c == '=') {
+        equals |= bit;
+      } else if (c == '\r') {
+        returns |= bit;
+      }
+    }
+    masks.newlines = newlines;
+    masks.equals = equals;
+    masks.returns = returns;
+  }
+
+#ifdef ARANGODB_PROGRAM_OPTIONS_SCANNER_X86
+  // SSE2 kernel, processing 4 x 16 bytes
+  __attribute__((target("sse2"))) static void scanBlockSSE2(
+      char const* data, IniScanMasks& masks) {
+    __m128i const newline = _mm_set1_epi8('\n');
+    __m128i const equal = _mm_set1_epi8('=');
+    __m128i const ret = _mm_set1_epi8('\r');
+
+    uint64_t newlines = 0;
+    uint64_t equals = 0;
+    uint64_t returns = 0;
+    for (size_t i = 0; i < BlockSize; i += 16) {
+      __m128i const chunk =
+          _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + i));
+      newlines |= static_cast<uint64_t>(static_cast<uint32_t>(
+                      _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline))))
+                  << i;
+      equals |= static_cast<uint64_t>(static_cast<uint32_t>(
+                    _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, equal))))
+                << i;
+      returns |= static_cast<uint64_t>(static_cast<uint32_t>(
+                     _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, ret))))
+                 << i;
+    }
+    masks.newlines = newlines;
+    masks.equals = equals;
+    masks.returns = returns;
+  }
+
+  // AVX2 kernel, processing 2 x 32 bytes
+  __attribute__((target("avx2"))) static void scanBlockAVX2(
+      char const* data, IniScanMasks& masks) {
+    __m256i const newline = _mm256_set1_epi8('\n');
+    __m256i const equal = _mm256_set1_epi8('=');
+    __m256i const ret = _mm256_set1_epi8('\r');
+
+    __m256i const lo =
+        _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data));
+    __m256i const hi =
+        _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + 32));
+
+    masks.newlines = combine(_mm256_cmpeq_epi8(lo, newline),
+                             _mm256_cmpeq_epi8(hi, newline));
+    masks.equals =
+        combine(_mm256_cmpeq_epi8(lo, equal), _mm256_cmpeq_epi8(hi, equal));
+    masks.returns =
+        combine(_mm256_cmpeq_epi8(lo, ret), _mm256_cmpeq_epi8(hi, ret));
+  }
+#endif
+
+  // return the best kernel for the current CPU. the decision is made once
+  static KernelType kernel() {
+    static KernelType const selected = selectKernel();
+    return selected;
+  }
+
+  // scan the input for complete lines, i.e. lines terminated by a '\n'.
+  // the callback is invoked for each line in order and may return false to
+  // abort the scan. returns the offset of the first byte that does not
+  // belong to a complete line, i.e. the start of the trailing partial line,
+  // or std::string::npos if the scan was aborted
+  template <typename F>
+  static size_t scan(char const* data, size_t length, F const& callback) {
+    return scan(kernel(), data, length, callback);
+  }
+
+  // same as above, but with a caller-provided kernel
+  template <typename F>
+  static size_t scan(KernelType kernel, char const* data, size_t length,
+                     F const& callback) {
+    IniLine line;
+    line.begin = 0;
+    line.equals = std::string::npos;
+    line.carriageReturn = false;
+
+    IniScanMasks masks;
+    size_t offset = 0;
+
+    while (offset < length) {
+      if (length - offset >= BlockSize) {
+        kernel(data + offset, masks);
+      } else {
+        // copy the remainder into a zero-padded block. padding bytes never
+        // match any of the scanned characters
+        char block[BlockSize];
+        memset(block, 0, sizeof(block));
+        memcpy(block, data + offset, length - offset);
+        kernel(block, masks);
+      }
+
+      uint64_t newlines = masks.newlines;
+      uint64_t equals = masks.equals;
+      uint64_t returns = masks.returns;
+
+      while (true) {
+        // all positions in front of the next newline (or the whole block)
+        uint64_t const nextNewline = newlines & (~newlines + 1);
+        uint64_t const before =
+            newlines == 0 ? ~uint64_t(0) : nextNewline - 1;
+
+        if (line.equals == std::string::npos && (equals & before) != 0) {
+          line.equals = offset + countTrailingZeros(equals & before);
+        }
+        if ((returns & before) != 0) {
+          line.carriageReturn = true;
+        }
+
+        if (newlines == 0) {
+          break;
+        }
+
+        line.end = offset + countTrailingZeros(newlines);
+        if (!callback(line)) {
+          return std::string::npos;
+        }
+        line.begin = line.end + 1;
+        line.equals = std::string::npos;
+        line.carriageReturn = false;
+
+        equals &= ~(before | nextNewline);
+        returns &= ~(before | nextNewline);
+        newlines &= newlines - 1;
+      }
+
+      offset += BlockSize;
+    }
+
+    return line.begin;
+  }
+
+ private:
+  static KernelType selectKernel() {
+#ifdef ARANGODB_PROGRAM_OPTIONS_SCANNER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+      return &scanBlockAVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+      return &scanBlockSSE2;
+    }
+#endif
+    return &scanBlockScalar;
+  }
+
+#ifdef ARANGODB_PROGRAM_OPTIONS_SCANNER_X86
+  __attribute__((target("avx2"))) static uint64_t combine(__m256i lo,
+                                                          __m256i hi) {
+    return static_cast<uint64_t>(
+               static_cast<uint32_t>(_mm256_movemask_epi8(lo))) |
+           (static_cast<uint64_t>(
+                static_cast<uint32_t>(_mm256_movemask_epi8(hi)))
+            << 32);
+  }
+#endif
+
+  static size_t countTrailingZeros(uint64_t value) {
+#if defined(__GNUC__)
+    return static_cast<size_t>(__builtin_ctzll(value));
+#else
+    size_t result = 0;
+    while ((value & 1) == 0) {
+      value >>= 1;
+      ++result;
+    }
+    return result;
+#endif
+  }
+};
+}
+}
+
+#endif
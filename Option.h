@@ -4,6 +4,7 @@
 #include <string>
 #include <iostream>
 #include <memory>
+#include <cstdint>
 
 #include "Parameters.h"
 
@@ -22,6 +23,7 @@ struct Option {
         description(description),
         shorthand(),
         parameter(parameter),
+        id(0),
         hidden(hidden),
         obsolete(obsolete) {
     auto parts = splitName(value);
@@ -46,6 +48,24 @@ struct Option {
     return section + '.' + name;
   }
 
+  // get the stable id for the option. in contrast to the dense id, it only
+  // depends on the full option name, so it is the same in all processes
+  uint64_t stableId() const { return stableId(fullName()); }
+
+  // get the stable id for a full option name (64 bit FNV-1a hash)
+  static uint64_t stableId(std::string const& fullName) {
+    return stableId(fullName.data(), fullName.size());
+  }
+
+  static uint64_t stableId(char const* data, size_t length) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; ++i) {
+      hash ^= static_cast<unsigned char>(data[i]);
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
+
   // print help for an option
   void printHelp(size_t tw, size_t ow) const {
     if (!hidden) {
@@ -167,6 +187,8 @@ struct Option {
   std::string description;
   std::string shorthand;
   std::shared_ptr<Parameter> parameter;
+  // dense id of the option, assigned by ProgramOptions when it is added
+  size_t id;
   bool hidden;
   bool obsolete;
 };
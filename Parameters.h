@@ -3,9 +3,21 @@
 
 #include <string>
 #include <vector>
+#include <atomic>
+#include <functional>
 #include <limits>
+#include <memory>
+#include <mutex>
+#include <initializer_list>
+#include <unordered_map>
+#include <utility>
+#include <cmath>
 #include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
 #include <type_traits>
+#include <typeinfo>
 
 namespace arangodb {
 namespace options {
@@ -56,6 +68,350 @@ inline std::string stringifyValue<std::string>(std::string const& value) {
   return "\"" + value + "\"";
 }
 
+// append an integer value to a string, without going through a temporary
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value>::type appendNumber(
+    std::string& out, T value) {
+  char buffer[24];
+  char* p = buffer + sizeof(buffer);
+  bool const negative = value < 0;
+  // work on the unsigned magnitude, so the minimum value does not overflow
+  typename std::make_unsigned<T>::type v =
+      negative ? static_cast<typename std::make_unsigned<T>::type>(
+                     ~static_cast<typename std::make_unsigned<T>::type>(value) + 1)
+               : static_cast<typename std::make_unsigned<T>::type>(value);
+  do {
+    *--p = static_cast<char>('0' + v % 10);
+    v /= 10;
+  } while (v != 0);
+  if (negative) {
+    *--p = '-';
+  }
+  out.append(p, buffer + sizeof(buffer) - p);
+}
+
+// append a double value to a string, using the shortest representation that
+// converts back to the same value
+inline void appendNumber(std::string& out, double value) {
+  char buffer[32];
+  int length = 0;
+  for (int precision = 15; precision <= 17; ++precision) {
+    length = snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+    if (!std::isfinite(value) || strtod(buffer, nullptr) == value) {
+      break;
+    }
+  }
+  out.append(buffer, static_cast<size_t>(length));
+}
+
+// append a string to a string as a quoted and escaped JSON string
+inline void appendJsonString(std::string& out, std::string const& value) {
+  static char const* const hex = "0123456789abcdef";
+  out.push_back('"');
+  for (char c : value) {
+    switch (c) {
+      case '"':
+        out.append("\\\"");
+        break;
+      case '\\':
+        out.append("\\\\");
+        break;
+      case '\n':
+        out.append("\\n");
+        break;
+      case '\r':
+        out.append("\\r");
+        break;
+      case '\t':
+        out.append("\\t");
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          out.append("\\u00");
+          out.push_back(hex[(c >> 4) & 0xf]);
+          out.push_back(hex[c & 0xf]);
+        } else {
+          out.push_back(c);
+        }
+    }
+  }
+  out.push_back('"');
+}
+
+// remove the quotes stringifyValue() puts around string values, if any
+inline std::string unquoteValue(std::string const& value) {
+  if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+    return value.substr(1, value.size() - 2);
+  }
+  return value;
+}
+
+// append a value to a string in the form accepted by Parameter::set()
+template <typename T>
+inline void appendValue(std::string& out, T const& value) {
+  appendNumber(out, value);
+}
+
+// append a boolean value, specialized version
+template <>
+inline void appendValue<bool>(std::string& out, bool const& value) {
+  out.append(value ? "true" : "false");
+}
+
+// append a string value, specialized version
+template <>
+inline void appendValue<std::string>(std::string& out,
+                                     std::string const& value) {
+  out.append(value);
+}
+
+// append a value to a string as JSON
+template <typename T>
+inline void appendJsonValue(std::string& out, T const& value) {
+  appendNumber(out, value);
+}
+
+// append a double value as JSON, specialized version. JSON has no
+// representation for infinity and NaN
+template <>
+inline void appendJsonValue<double>(std::string& out, double const& value) {
+  if (std::isfinite(value)) {
+    appendNumber(out, value);
+  } else {
+    out.append("null");
+  }
+}
+
+// append a boolean value as JSON, specialized version
+template <>
+inline void appendJsonValue<bool>(std::string& out, bool const& value) {
+  appendValue(out, value);
+}
+
+// append a string value as JSON, specialized version
+template <>
+inline void appendJsonValue<std::string>(std::string& out,
+                                         std::string const& value) {
+  appendJsonString(out, value);
+}
+
+struct Parameter;
+template <typename T>
+struct BoundedParameter;
+
+// value types of the built-in parameter types
+enum class VariantType : uint8_t {
+  Custom,
+  Boolean,
+  Flag,
+  Int16,
+  UInt16,
+  Int32,
+  UInt32,
+  Int64,
+  UInt64,
+  Double,
+  String
+};
+
+// shapes of the built-in parameter types
+enum class VariantKind : uint8_t { Single, Bounded, Vector };
+
+// closed representation of the built-in parameter types (BooleanParameter,
+// the numeric parameters, StringParameter, and their bounded and vector
+// versions): a type tag plus the parameter. the fields of the parameter
+// (ptr, and min and max for bounded parameters) are read on every call, so
+// later changes of them take effect. variants can also be created for a
+// variable instead of a parameter, e.g. for static options.
+// functions are dispatched via a switch on the tag, which constructs the
+// regular parameter type on the stack, so the calls are not virtual and the
+// values are the same as with the parameter objects. the variants of many
+// options can be stored in a dense array. all other parameter types,
+// including types derived from the built-in ones, are Custom and are called
+// via the Parameter interface
+class ParameterVariant {
+ public:
+  // create a variant of a parameter, which must outlive the variant
+  static ParameterVariant of(Parameter* parameter);
+
+  ParameterVariant()
+      : _target(nullptr),
+        _parameter(nullptr),
+        _type(VariantType::Custom),
+        _kind(VariantKind::Single) {}
+
+  ParameterVariant(bool* target, bool requiresValue)
+      : _target(target),
+        _parameter(nullptr),
+        _type(requiresValue ? VariantType::Boolean : VariantType::Flag),
+        _kind(VariantKind::Single) {}
+
+  template <typename T>
+  explicit ParameterVariant(T* target)
+      : _target(target),
+        _parameter(nullptr),
+        _type(typeOf(target)),
+        _kind(VariantKind::Single) {}
+
+  template <typename T>
+  explicit ParameterVariant(BoundedParameter<T> const* bounded)
+      : _target(nullptr),
+        _parameter(bounded),
+        _type(typeOf(bounded->ptr)),
+        _kind(VariantKind::Bounded) {}
+
+  template <typename T>
+  explicit ParameterVariant(std::vector<T>* target)
+      : _target(target),
+        _parameter(nullptr),
+        _type(typeOf(static_cast<T*>(nullptr))),
+        _kind(VariantKind::Vector) {}
+
+  VariantType type() const { return _type; }
+  VariantKind kind() const { return _kind; }
+
+  // the functions of the Parameter interface
+  bool requiresValue() const;
+  std::string set(std::string const& value);
+  std::string check(std::string const& value) const;
+  std::string setValidated(std::string const& value);
+  std::string valueString() const;
+  size_t valueCount() const;
+  void appendValue(std::string& out, size_t index) const;
+  void appendJson(std::string& out) const;
+  bool multipleValues() const;
+  void clear();
+
+ private:
+  // operations dispatched via visit(), applied to the parameter
+  struct RequiresValueOp {
+    typedef bool ResultType;
+    template <typename P>
+    bool operator()(P& parameter) const {
+      return parameter.requiresValue();
+    }
+  };
+
+  struct SetOp {
+    typedef std::string ResultType;
+    template <typename P>
+    std::string operator()(P& parameter) const {
+      return validated ? parameter.setValidated(value) : parameter.set(value);
+    }
+    std::string const& value;
+    bool validated;
+  };
+
+  struct CheckOp {
+    typedef std::string ResultType;
+    template <typename P>
+    std::string operator()(P& parameter) const {
+      return parameter.check(value);
+    }
+    std::string const& value;
+  };
+
+  struct ValueStringOp {
+    typedef std::string ResultType;
+    template <typename P>
+    std::string operator()(P& parameter) const {
+      return parameter.valueString();
+    }
+  };
+
+  struct ValueCountOp {
+    typedef size_t ResultType;
+    template <typename P>
+    size_t operator()(P& parameter) const {
+      return parameter.valueCount();
+    }
+  };
+
+  struct AppendValueOp {
+    typedef void ResultType;
+    template <typename P>
+    void operator()(P& parameter) const {
+      parameter.appendValue(out, index);
+    }
+    std::string& out;
+    size_t index;
+  };
+
+  struct AppendJsonOp {
+    typedef void ResultType;
+    template <typename P>
+    void operator()(P& parameter) const {
+      parameter.appendJson(out);
+    }
+    std::string& out;
+  };
+
+  struct MultipleValuesOp {
+    typedef bool ResultType;
+    template <typename P>
+    bool operator()(P& parameter) const {
+      return parameter.multipleValues();
+    }
+  };
+
+  struct ClearOp {
+    typedef void ResultType;
+    template <typename P>
+    void operator()(P& parameter) const {
+      parameter.clear();
+    }
+  };
+
+  struct TypeOp {
+    typedef std::type_info const* ResultType;
+    template <typename P>
+    std::type_info const* operator()(P& parameter) const {
+      return &typeid(parameter);
+    }
+  };
+
+  // the tag of each value type. all other types are Custom
+  template <typename T>
+  static VariantType typeOf(T*) {
+    return VariantType::Custom;
+  }
+  static VariantType typeOf(bool*) { return VariantType::Boolean; }
+  static VariantType typeOf(int16_t*) { return VariantType::Int16; }
+  static VariantType typeOf(uint16_t*) { return VariantType::UInt16; }
+  static VariantType typeOf(int32_t*) { return VariantType::Int32; }
+  static VariantType typeOf(uint32_t*) { return VariantType::UInt32; }
+  static VariantType typeOf(int64_t*) { return VariantType::Int64; }
+  static VariantType typeOf(uint64_t*) { return VariantType::UInt64; }
+  static VariantType typeOf(double*) { return VariantType::Double; }
+  static VariantType typeOf(std::string*) { return VariantType::String; }
+
+  // apply an operation to the parameter, constructed on the stack for the
+  // built-in types
+  template <typename Op>
+  typename Op::ResultType visit(Op const& op) const;
+
+  // apply an operation to a numeric parameter of type P, or its bounded or
+  // vector version
+  template <typename P, typename Op>
+  typename Op::ResultType visitNumber(Op const& op) const;
+
+  // the variable of a parameter of type P: the current ptr field of the
+  // parameter, or the variable the variant was created for
+  template <typename P, typename T>
+  T* target() const {
+    return _parameter != nullptr ? static_cast<P const*>(_parameter)->ptr
+                                 : static_cast<T*>(_target);
+  }
+
+  // the variable the value is stored in if the variant was created for a
+  // variable, or the parameter if Custom
+  void* _target;
+  // the parameter, if the variant was created for a built-in parameter
+  Parameter const* _parameter;
+  VariantType _type;
+  VariantKind _kind;
+};
+
 // abstract base parameter type struct
 struct Parameter {
   Parameter() = default;
@@ -66,6 +422,44 @@ struct Parameter {
   virtual std::string valueString() const = 0;
   virtual std::string set(std::string const&) = 0;
 
+  // check whether a value would be accepted by set(), without setting it.
+  // returns an error message, or an empty string if the value is valid.
+  // parameter types that cannot check their values accept everything here
+  virtual std::string check(std::string const&) const { return ""; }
+
+  // set a value that check() has already accepted. parameter types with
+  // expensive checks can override this to skip checking the value again
+  virtual std::string setValidated(std::string const& value) {
+    return set(value);
+  }
+
+  // number of values that have to be passed to set() to reproduce the
+  // current value. this is 0 if the value cannot be reproduced
+  virtual size_t valueCount() const { return 1; }
+
+  // append the value with the given index to out, in the form accepted by
+  // set()
+  virtual void appendValue(std::string& out, size_t /*index*/) const {
+    out.append(unquoteValue(valueString()));
+  }
+
+  // append the value to out as JSON
+  virtual void appendJson(std::string& out) const {
+    appendJsonString(out, unquoteValue(valueString()));
+  }
+
+  // whether or not set() adds a value to the existing ones instead of
+  // replacing the value
+  virtual bool multipleValues() const { return false; }
+
+  // remove all values, including the default ones. only called if
+  // multipleValues() is true
+  virtual void clear() {}
+
+  // describe the parameter as a variant, if it is of one of the built-in
+  // types. returns false otherwise
+  virtual bool toVariant(ParameterVariant&) const { return false; }
+
   virtual std::string typeDescription() const {
     if (requiresValue()) {
       return std::string("<") + name() + std::string(">");
@@ -86,14 +480,32 @@ struct BooleanParameter : public Parameter {
   std::string valueString() const override { return stringifyValue(*ptr); }
 
   std::string set(std::string const& value) override {
+    std::string result = check(value);
+    if (result.empty()) {
+      *ptr = (!required || value == "true" || value == "on" || value == "1");
+    }
+    return result;
+  }
+
+  std::string check(std::string const& value) const override {
     if (!required || value == "true" || value == "false" || value == "on" ||
         value == "off" || value == "1" || value == "0") {
-      *ptr = (!required || value == "true" || value == "on" || value == "1");
       return "";
     }
     return "invalid value. expecting 'true' or 'false'";
   }
 
+  // a flag cannot be set to false, so it is only written out if it is set
+  size_t valueCount() const override { return (required || *ptr) ? 1 : 0; }
+
+  void appendValue(std::string& out, size_t) const override {
+    options::appendValue(out, *ptr);
+  }
+
+  void appendJson(std::string& out) const override {
+    appendJsonValue(out, *ptr);
+  }
+
   std::string typeDescription() const override {
     if (required) {
       return Parameter::typeDescription();
@@ -101,6 +513,11 @@ struct BooleanParameter : public Parameter {
     return "";
   }
 
+  bool toVariant(ParameterVariant& out) const override {
+    out = ParameterVariant(ptr, required);
+    return true;
+  }
+
   ValueType* ptr;
   bool required;
 };
@@ -116,11 +533,26 @@ struct NumericParameter : public Parameter {
   std::string valueString() const override { return stringifyValue(*ptr); }
 
   std::string set(std::string const& value) override {
+    ValueType v = 0;
+    std::string result = parse(value, v);
+    if (result.empty()) {
+      *ptr = v;
+    }
+    return result;
+  }
+
+  std::string check(std::string const& value) const override {
+    ValueType v = 0;
+    return parse(value, v);
+  }
+
+  // convert a string into a number. returns an error message, or an empty
+  // string if all is well
+  virtual std::string parse(std::string const& value, ValueType& v) const {
     try {
-      ValueType v = toNumber<ValueType>(value);
-      if (v >= std::numeric_limits<T>::min() &&
+      v = toNumber<ValueType>(value);
+      if (v >= std::numeric_limits<T>::lowest() &&
           v <= std::numeric_limits<T>::max()) {
-        *ptr = v;
         return "";
       }
     } catch (...) {
@@ -129,6 +561,19 @@ struct NumericParameter : public Parameter {
     return "number out of range";
   }
 
+  void appendValue(std::string& out, size_t) const override {
+    options::appendValue(out, *ptr);
+  }
+
+  void appendJson(std::string& out) const override {
+    appendJsonValue(out, *ptr);
+  }
+
+  bool toVariant(ParameterVariant& out) const override {
+    out = ParameterVariant(ptr);
+    return out.type() != VariantType::Custom;
+  }
+
   ValueType* ptr;
 };
 
@@ -192,13 +637,13 @@ struct BoundedParameter : public T {
                    typename T::ValueType max)
       : T(ptr), min(min), max(max) {}
 
-  std::string set(std::string const& value) override {
+  std::string parse(std::string const& value,
+                    typename T::ValueType& v) const override {
     try {
-      typename T::ValueType v = toNumber<typename T::ValueType>(value);
-      if (v >= std::numeric_limits<typename T::ValueType>::min() &&
+      v = toNumber<typename T::ValueType>(value);
+      if (v >= std::numeric_limits<typename T::ValueType>::lowest() &&
           v <= std::numeric_limits<typename T::ValueType>::max() && v >= min &&
           v <= max) {
-        *this->ptr = v;
         return "";
       }
     } catch (...) {
@@ -208,6 +653,11 @@ struct BoundedParameter : public T {
            std::to_string(max) + ")";
   }
 
+  bool toVariant(ParameterVariant& out) const override {
+    out = ParameterVariant(this);
+    return out.type() != VariantType::Custom;
+  }
+
   typename T::ValueType min;
   typename T::ValueType max;
 };
@@ -235,6 +685,19 @@ struct StringParameter : public Parameter {
     return "";
   }
 
+  void appendValue(std::string& out, size_t) const override {
+    options::appendValue(out, *ptr);
+  }
+
+  void appendJson(std::string& out) const override {
+    appendJsonValue(out, *ptr);
+  }
+
+  bool toVariant(ParameterVariant& out) const override {
+    out = ParameterVariant(ptr);
+    return true;
+  }
+
   ValueType* ptr;
 };
 
@@ -272,16 +735,503 @@ struct VectorParameter : public Parameter {
     return result;
   }
 
+  std::string check(std::string const& value) const override {
+    typename T::ValueType dummy;
+    T param(&dummy);
+    return param.check(value);
+  }
+
+  std::string setValidated(std::string const& value) override {
+    typename T::ValueType dummy;
+    T param(&dummy);
+    std::string result = param.setValidated(value);
+    if (result.empty()) {
+      ptr->push_back(*(param.ptr));
+    }
+    return result;
+  }
+
+  size_t valueCount() const override { return ptr->size(); }
+
+  bool multipleValues() const override { return true; }
+
+  void clear() override { ptr->clear(); }
+
+  void appendValue(std::string& out, size_t index) const override {
+    typename T::ValueType value = ptr->at(index);
+    T param(&value);
+    param.appendValue(out, 0);
+  }
+
+  void appendJson(std::string& out) const override {
+    out.push_back('[');
+    for (size_t i = 0; i < ptr->size(); ++i) {
+      if (i > 0) {
+        out.push_back(',');
+      }
+      typename T::ValueType value = ptr->at(i);
+      T param(&value);
+      param.appendJson(out);
+    }
+    out.push_back(']');
+  }
+
+  bool toVariant(ParameterVariant& out) const override {
+    out = ParameterVariant(ptr);
+    // vectors of booleans are not supported as variants
+    return out.type() != VariantType::Custom &&
+           out.type() != VariantType::Boolean;
+  }
+
   std::vector<typename T::ValueType>* ptr;
 };
 
+// the allowed values for a DiscreteValuesParameter
+// each value can have multiple spellings. the first spelling of a value is
+// used when printing it. spellings are looked up in a hash table, so the
+// cost of matching an input does not depend on the number of choices
+template <typename E>
+class DiscreteValues {
+ public:
+  typedef std::pair<char const*, E> SpellingType;
+
+  DiscreteValues(std::initializer_list<SpellingType> spellings) {
+    for (auto const& it : spellings) {
+      if (!_values.emplace(it.first, it.second).second) {
+        throw std::logic_error(std::string("duplicate spelling '") +
+                               it.first + "'");
+      }
+      if (_names.emplace(key(it.second), _spellings.size()).second) {
+        _spellings.emplace_back(it.first);
+      }
+      if (!_choices.empty()) {
+        _choices.append(", ");
+      }
+      _choices.append("'" + std::string(it.first) + "'");
+    }
+    for (auto const& it : _spellings) {
+      if (!_typeName.empty()) {
+        _typeName.push_back('|');
+      }
+      _typeName.append(it);
+    }
+  }
+
+  // look up the value for a spelling. returns false if it is not allowed
+  bool find(std::string const& spelling, E& value) const {
+    auto it = _values.find(spelling);
+    if (it == _values.end()) {
+      return false;
+    }
+    value = (*it).second;
+    return true;
+  }
+
+  // get the spelling of a value, or an empty string if it is not allowed
+  std::string const& spelling(E value) const {
+    static std::string const empty;
+    auto it = _names.find(key(value));
+    if (it == _names.end()) {
+      return empty;
+    }
+    return _spellings[(*it).second];
+  }
+
+  // list of all spellings, for error messages
+  std::string const& choices() const { return _choices; }
+
+  // the first spelling of each value, separated by '|', for the help
+  std::string const& typeName() const { return _typeName; }
+
+ private:
+  typedef typename std::underlying_type<E>::type KeyType;
+
+  static KeyType key(E value) { return static_cast<KeyType>(value); }
+
+  // value of each spelling
+  std::unordered_map<std::string, E> _values;
+  // index of the first spelling of each value in _spellings
+  std::unordered_map<KeyType, size_t> _names;
+  // first spelling of each value
+  std::vector<std::string> _spellings;
+  // all spellings, quoted and separated by commas
+  std::string _choices;
+  // first spelling of each value, separated by '|'
+  std::string _typeName;
+};
+
+// specialized type for a fixed set of values, e.g. names of log levels,
+// that are mapped to an enum
+template <typename E>
+struct DiscreteValuesParameter : public Parameter {
+  typedef E ValueType;
+
+  DiscreteValuesParameter(
+      ValueType* ptr,
+      std::initializer_list<typename DiscreteValues<E>::SpellingType> values)
+      : ptr(ptr), values(std::make_shared<DiscreteValues<E> const>(values)) {}
+
+  DiscreteValuesParameter(ValueType* ptr,
+                          std::shared_ptr<DiscreteValues<E> const> values)
+      : ptr(ptr), values(values) {}
+
+  std::string name() const override { return values->typeName(); }
+
+  std::string valueString() const override {
+    return stringifyValue(values->spelling(*ptr));
+  }
+
+  std::string set(std::string const& value) override {
+    if (values->find(value, *ptr)) {
+      return "";
+    }
+    return check(value);
+  }
+
+  std::string check(std::string const& value) const override {
+    E v;
+    if (values->find(value, v)) {
+      return "";
+    }
+    return "invalid value '" + value + "'. possible values: " +
+           values->choices();
+  }
+
+  void appendValue(std::string& out, size_t) const override {
+    out.append(values->spelling(*ptr));
+  }
+
+  void appendJson(std::string& out) const override {
+    appendJsonString(out, values->spelling(*ptr));
+  }
+
+  ValueType* ptr;
+  std::shared_ptr<DiscreteValues<E> const> values;
+};
+
+// vectors of discrete values. the allowed values are shared by all elements
+template <typename E>
+struct VectorParameter<DiscreteValuesParameter<E>> : public Parameter {
+  VectorParameter(
+      std::vector<E>* ptr,
+      std::initializer_list<typename DiscreteValues<E>::SpellingType> values)
+      : ptr(ptr), values(std::make_shared<DiscreteValues<E> const>(values)) {}
+
+  VectorParameter(std::vector<E>* ptr,
+                  std::shared_ptr<DiscreteValues<E> const> values)
+      : ptr(ptr), values(values) {}
+
+  std::string name() const override { return values->typeName() + "..."; }
+
+  std::string valueString() const override {
+    std::string value;
+    for (size_t i = 0; i < ptr->size(); ++i) {
+      if (i > 0) {
+        value.append(", ");
+      }
+      value.append(stringifyValue(values->spelling(ptr->at(i))));
+    }
+    return value;
+  }
+
+  std::string set(std::string const& value) override {
+    E v;
+    if (values->find(value, v)) {
+      ptr->push_back(v);
+      return "";
+    }
+    return check(value);
+  }
+
+  std::string check(std::string const& value) const override {
+    E v;
+    if (values->find(value, v)) {
+      return "";
+    }
+    return "invalid value '" + value + "'. possible values: " +
+           values->choices();
+  }
+
+  size_t valueCount() const override { return ptr->size(); }
+
+  bool multipleValues() const override { return true; }
+
+  void clear() override { ptr->clear(); }
+
+  void appendValue(std::string& out, size_t index) const override {
+    out.append(values->spelling(ptr->at(index)));
+  }
+
+  void appendJson(std::string& out) const override {
+    out.push_back('[');
+    for (size_t i = 0; i < ptr->size(); ++i) {
+      if (i > 0) {
+        out.push_back(',');
+      }
+      appendJsonString(out, values->spelling(ptr->at(i)));
+    }
+    out.push_back(']');
+  }
+
+  std::vector<E>* ptr;
+  std::shared_ptr<DiscreteValues<E> const> values;
+};
+
+// a value that is only converted from its string representation when it is
+// first accessed, for conversions that are expensive (e.g. resolving host
+// names or loading key files). setting the value only stores the raw string
+// and runs an optional cheap syntax check, so values that are overridden by
+// a later source or never read do not cost anything. the converted value is
+// memoized, and concurrent first accesses convert only once.
+// the value must not be set while other threads access it
+template <typename T>
+class Deferred {
+ public:
+  typedef T ValueType;
+
+  // convert a raw value. returns an error message, or an empty string if
+  // all is well
+  typedef std::function<std::string(std::string const&, T&)> ConvertFuncType;
+  // check the syntax of a raw value. returns an error message, or an empty
+  // string if all is well
+  typedef std::function<std::string(std::string const&)> CheckFuncType;
+
+  Deferred(std::string const& raw, ConvertFuncType const& convert,
+           CheckFuncType const& check = nullptr)
+      : _raw(raw), _convert(convert), _check(check), _resolved(false) {}
+
+  // no need to copy this
+  Deferred(Deferred const&) = delete;
+  Deferred& operator=(Deferred const&) = delete;
+
+  // the raw value, as set
+  std::string const& raw() const { return _raw; }
+
+  // whether or not the value was already converted
+  bool resolved() const { return _resolved.load(std::memory_order_acquire); }
+
+  // check the syntax of a raw value, without converting it
+  std::string check(std::string const& raw) const {
+    if (_check) {
+      return _check(raw);
+    }
+    return "";
+  }
+
+  // replace the raw value. the new value is converted on the next access
+  void assign(std::string const& raw) {
+    std::lock_guard<std::mutex> guard(_mutex);
+    _raw = raw;
+    _resolved.store(false, std::memory_order_release);
+  }
+
+  // convert the value if this has not happened yet. returns the conversion
+  // error, or an empty string if all is well. this can be used to convert
+  // the value at a defined point in time and report errors
+  std::string const& resolve() const {
+    if (!_resolved.load(std::memory_order_acquire)) {
+      std::lock_guard<std::mutex> guard(_mutex);
+      if (!_resolved.load(std::memory_order_relaxed)) {
+        _value = T();
+        _error = _convert(_raw, _value);
+        _resolved.store(true, std::memory_order_release);
+      }
+    }
+    return _error;
+  }
+
+  // the converted value. converts the value on first access, and throws if
+  // the conversion fails
+  T const& value() const {
+    if (!resolve().empty()) {
+      throw std::runtime_error("invalid value '" + _raw + "': " + _error);
+    }
+    return _value;
+  }
+
+ private:
+  std::string _raw;
+  ConvertFuncType _convert;
+  CheckFuncType _check;
+  mutable T _value;
+  mutable std::string _error;
+  mutable std::atomic<bool> _resolved;
+  mutable std::mutex _mutex;
+};
+
+// parameter type for deferred values. only the raw value is stored and
+// syntax-checked when the parameter is set, and the value is printed and
+// written out in its raw form, so it is never converted by the options
+// processing itself
+template <typename T>
+struct DeferredParameter : public Parameter {
+  typedef Deferred<T> ValueType;
+
+  explicit DeferredParameter(ValueType* ptr,
+                             std::string const& typeName = "string")
+      : ptr(ptr), typeName(typeName) {}
+
+  std::string name() const override { return typeName; }
+  std::string valueString() const override {
+    return stringifyValue(ptr->raw());
+  }
+
+  std::string set(std::string const& value) override {
+    std::string result = ptr->check(value);
+    if (result.empty()) {
+      ptr->assign(value);
+    }
+    return result;
+  }
+
+  std::string check(std::string const& value) const override {
+    return ptr->check(value);
+  }
+
+  std::string setValidated(std::string const& value) override {
+    ptr->assign(value);
+    return "";
+  }
+
+  void appendValue(std::string& out, size_t) const override {
+    out.append(ptr->raw());
+  }
+
+  void appendJson(std::string& out) const override {
+    appendJsonString(out, ptr->raw());
+  }
+
+  ValueType* ptr;
+  std::string typeName;
+};
+
 // a type that's useful for obsolete parameters that do nothing
 struct ObsoleteParameter : public Parameter {
   bool requiresValue() const override { return false; }
   std::string name() const override { return "obsolete"; }
   std::string valueString() const override { return "-"; }
   std::string set(std::string const&) override { return ""; }
+  size_t valueCount() const override { return 0; }
+  void appendJson(std::string& out) const override { out.append("null"); }
 };
+
+inline ParameterVariant ParameterVariant::of(Parameter* parameter) {
+  ParameterVariant result;
+  // the variant must construct exactly the type of the parameter, so that
+  // types derived from the built-in ones keep their behavior
+  if (parameter->toVariant(result) && result._type != VariantType::Custom &&
+      *result.visit(TypeOp()) == typeid(*parameter)) {
+    // refer to the parameter, so that its current ptr is used
+    result._target = nullptr;
+    result._parameter = parameter;
+    return result;
+  }
+  result = ParameterVariant();
+  result._target = parameter;
+  return result;
+}
+
+inline bool ParameterVariant::requiresValue() const {
+  return visit(RequiresValueOp());
+}
+
+inline std::string ParameterVariant::set(std::string const& value) {
+  return visit(SetOp{value, false});
+}
+
+inline std::string ParameterVariant::check(std::string const& value) const {
+  return visit(CheckOp{value});
+}
+
+inline std::string ParameterVariant::setValidated(std::string const& value) {
+  return visit(SetOp{value, true});
+}
+
+inline std::string ParameterVariant::valueString() const {
+  return visit(ValueStringOp());
+}
+
+inline size_t ParameterVariant::valueCount() const {
+  return visit(ValueCountOp());
+}
+
+inline void ParameterVariant::appendValue(std::string& out,
+                                          size_t index) const {
+  visit(AppendValueOp{out, index});
+}
+
+inline void ParameterVariant::appendJson(std::string& out) const {
+  visit(AppendJsonOp{out});
+}
+
+inline bool ParameterVariant::multipleValues() const {
+  return visit(MultipleValuesOp());
+}
+
+inline void ParameterVariant::clear() { visit(ClearOp()); }
+
+template <typename Op>
+typename Op::ResultType ParameterVariant::visit(Op const& op) const {
+  switch (_type) {
+    case VariantType::Custom:
+      return op(*static_cast<Parameter*>(_target));
+    case VariantType::Boolean:
+    case VariantType::Flag: {
+      BooleanParameter parameter(target<BooleanParameter, bool>(),
+                                 _type == VariantType::Boolean);
+      return op(parameter);
+    }
+    case VariantType::Int16:
+      return visitNumber<Int16Parameter>(op);
+    case VariantType::UInt16:
+      return visitNumber<UInt16Parameter>(op);
+    case VariantType::Int32:
+      return visitNumber<Int32Parameter>(op);
+    case VariantType::UInt32:
+      return visitNumber<UInt32Parameter>(op);
+    case VariantType::Int64:
+      return visitNumber<Int64Parameter>(op);
+    case VariantType::UInt64:
+      return visitNumber<UInt64Parameter>(op);
+    case VariantType::Double:
+      return visitNumber<DoubleParameter>(op);
+    case VariantType::String: {
+      if (_kind == VariantKind::Vector) {
+        VectorParameter<StringParameter> parameter(
+            target<VectorParameter<StringParameter>,
+                   std::vector<std::string>>());
+        return op(parameter);
+      }
+      StringParameter parameter(target<StringParameter, std::string>());
+      return op(parameter);
+    }
+  }
+  return op(*static_cast<Parameter*>(_target));
+}
+
+template <typename P, typename Op>
+typename Op::ResultType ParameterVariant::visitNumber(Op const& op) const {
+  typedef typename P::ValueType ValueType;
+
+  switch (_kind) {
+    case VariantKind::Bounded: {
+      // read the current fields of the parameter
+      auto const& bounded =
+          *static_cast<BoundedParameter<P> const*>(_parameter);
+      BoundedParameter<P> parameter(bounded.ptr, bounded.min, bounded.max);
+      return op(parameter);
+    }
+    case VariantKind::Vector: {
+      VectorParameter<P> parameter(
+          target<VectorParameter<P>, std::vector<ValueType>>());
+      return op(parameter);
+    }
+    case VariantKind::Single:
+      break;
+  }
+  P parameter(target<P, ValueType>());
+  return op(parameter);
+}
 }
 }
 
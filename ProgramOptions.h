@@ -3,17 +3,26 @@
 
 #include <string>
 #include <map>
+#include <set>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 #include <iostream>
 #include <algorithm>
 #include <stdexcept>
 #include <cstring>
 #include <functional>
+#include <memory>
+#include <cstdint>
 
+#include "HelpIndex.h"
 #include "Option.h"
+#include "ReadProfiler.h"
 #include "Section.h"
+#include "StaticSchema.h"
+#include "ThreadPool.h"
+#include "Token.h"
 
 #define ARANGODB_PROGRAM_OPTIONS_PROGNAME "#progname#"
 
@@ -49,11 +58,55 @@ class ProgramOptions {
     bool _failed;
   };
 
+  // a layer that set the value of an option
+  struct ValueOrigin {
+    ValueOrigin(SourceLocation const& location, std::string const& value)
+        : location(location), value(value) {}
+
+    // where the value came from
+    SourceLocation location;
+    // the value as it was specified
+    std::string value;
+  };
+
+  // the effective value of an option and the layers that set it
+  struct Provenance {
+    // maximal number of layers kept per option. older layers are dropped,
+    // so that repeated parsing (e.g. reloading config files) does not
+    // accumulate memory
+    enum : size_t { MaxLayers = 16 };
+
+    // the effective value, as returned by Parameter::valueString()
+    std::string value;
+    // the layers that set the value, most recent first. for vector options
+    // all layers contribute to the value, for all other options the first
+    // layer has overridden all others. if empty, the default is in effect
+    std::vector<ValueOrigin> layers;
+  };
+
   // function type for determining terminal width
   typedef std::function<size_t()> TerminalWidthFuncType;
   // function type for determining the similarity between two strings
   typedef std::function<int(std::string const&, std::string const&)>
       SimilarityFuncType;
+  // function type for checking a constraint between options. returns an
+  // error message if the constraint is violated, and an empty string otherwise
+  typedef std::function<std::string()> ConstraintFuncType;
+  // function type for change listeners
+  typedef std::function<void()> ChangeFuncType;
+
+  // handle of a change listener, for removing it
+  struct ListenerHandle {
+    // id of the option the listener was added for
+    size_t option;
+    // id of the listener, unique for all listeners
+    uint64_t id;
+  };
+  // function type for registering the options of a lazy section
+  typedef std::function<void(ProgramOptions&)> SectionProviderFuncType;
+  // function type for consuming positional arguments. returns an error
+  // message if the argument is rejected, and an empty string otherwise
+  typedef std::function<std::string(std::string const&)> PositionalFuncType;
 
   // no need to copy this
   ProgramOptions(ProgramOptions const&) = delete;
@@ -66,10 +119,19 @@ class ProgramOptions {
       : _progname(progname),
         _usage(usage),
         _more(more),
+        _locationSourceId(0),
         _terminalWidth(terminalWidth),
         _similarity(similarity),
         _processingResult(),
-        _sealed(false) {
+        _sealed(false),
+        _readProfiler(nullptr),
+        _materializing(nullptr),
+        _droppedRecords(0),
+        _nextListenerId(0) {
+    // the empty source name (e.g. for the command line) always has index 0
+    _sourceNames.emplace_back();
+    _sourceIds.emplace("", 0);
+
     // find progname wildcard in string
     size_t const pos = _usage.find(ARANGODB_PROGRAM_OPTIONS_PROGNAME);
 
@@ -90,13 +152,44 @@ class ProgramOptions {
   // tryin to add an option or a section after sealing will throw an error
   void seal() { _sealed = true; }
 
+  // whether or not the options are sealed
+  bool sealed() const { return _sealed; }
+
   // set context for error reporting
-  void setContext(std::string const& value) { _context = value; }
+  // values set after this are recorded with an unknown source location
+  void setContext(std::string const& value) {
+    _context = value;
+    _location = SourceLocation();
+    _locationSourceId = 0;
+  }
+
+  // set the source location for error reporting and provenance tracking.
+  // the context string is only built from the location if an error is
+  // actually reported
+  void setLocation(SourceLocation const& location) {
+    if (location.name != _location.name) {
+      _locationSourceId = sourceId(location.name);
+    }
+    _location = location;
+    _context.clear();
+  }
 
   // adds a section to the options
   void addSection(Section const& section) {
-    checkIfSealed();
-    _sections.emplace(section.name, section);
+    checkIfMutable(section.name);
+    if (_materializing == nullptr &&
+        _lazySections.find(section.name) != _lazySections.end()) {
+      throw std::logic_error("section '" + section.name +
+                             "' is already declared as a lazy section");
+    }
+    auto result = _sections.emplace(section.name, section);
+
+    if (result.second) {
+      // options may have been added to the section directly
+      for (auto& it : (*result.first).second.options) {
+        registerOption(it.second);
+      }
+    }
   }
 
   // adds a (regular) section to the program options
@@ -115,6 +208,71 @@ class ProgramOptions {
     addSection(Section(name, "", "", true, true));
   }
 
+  // declares a section whose options are registered on demand. the
+  // provider is called with the options when the section is first needed,
+  // i.e. when an option of the section is looked up or set, or when help
+  // for it is printed or all options are walked. the provider must add the
+  // section and may only add options to this section. it may be called
+  // after the options have been sealed
+  // as looking up options may register lazy sections, the lookup functions
+  // are not const. all lazy sections must be registered (e.g. by walking
+  // all options) before options are looked up by multiple threads
+  void addLazySection(std::string const& name,
+                      SectionProviderFuncType const& provider) {
+    checkIfSealed();
+    if (_sections.find(name) != _sections.end() ||
+        !_lazySections.emplace(name, provider).second) {
+      throw std::logic_error("section '" + name + "' is already defined");
+    }
+  }
+
+  // names of all lazy sections whose options have not been registered yet
+  std::vector<std::string> lazySections() const {
+    std::vector<std::string> result;
+    for (auto const& it : _lazySections) {
+      result.emplace_back(it.first);
+    }
+    return result;
+  }
+
+  // returns the section with the given name, or nullptr if it does not
+  // exist. registers the options of a lazy section
+  Section const* findSection(std::string const& name) {
+    auto it = _sections.find(name);
+
+    if (it == _sections.end()) {
+      if (!materializeSection(name)) {
+        return nullptr;
+      }
+      it = _sections.find(name);
+    }
+
+    return &(*it).second;
+  }
+
+  // adds the options of a static schema. the schema must outlive the
+  // options. static options can be set by all parsers like regular options,
+  // but they are not visited by walk(), and their values are not recorded
+  // for provenance tracking. thus they are also not written by ConfigWriter,
+  // captured by ConfigDelta or exported by SharedConfig
+  void addStaticSchema(StaticSchemaBase const* schema) {
+    checkIfSealed();
+    for (size_t i = 0; i < schema->size(); ++i) {
+      char const* name = schema->option(i).name;
+      if (findOption(name) != nullptr || findStaticOption(name) != nullptr) {
+        throw std::logic_error(std::string("option already defined: --") +
+                               name);
+      }
+    }
+    _staticSchemas.emplace_back(schema);
+    _helpIndex.reset();
+  }
+
+  // the static schemas added via addStaticSchema()
+  std::vector<StaticSchemaBase const*> const& staticSchemas() const {
+    return _staticSchemas;
+  }
+
   // adds an option to the program options
   void addOption(std::string const& name, std::string const& description,
                  Parameter* parameter) {
@@ -133,17 +291,147 @@ class ProgramOptions {
     addOption(Option(name, description, new ObsoleteParameter(), true, true));
   }
 
+  // adds a constraint between options, e.g. that two vector options must
+  // have the same number of values. names lists the options the constraint
+  // reads, "section.*" stands for all options of a section. the constraint
+  // is checked by checkConstraints() if one of these options has been set
+  // since the constraint was last checked
+  void addConstraint(std::vector<std::string> const& names,
+                     std::string const& description,
+                     ConstraintFuncType const& check) {
+    if (_materializing == nullptr) {
+      // providers of lazy sections may add constraints
+      checkIfSealed();
+    }
+    uint32_t const index = static_cast<uint32_t>(_constraints.size());
+    _constraints.emplace_back(description, check);
+    _constraintDirty.emplace_back(false);
+
+    for (auto const& it : names) {
+      auto parts = Option::splitName(it);
+
+      if (parts.second == "*" &&
+          _lazySections.find(parts.first) != _lazySections.end()) {
+        // the options are registered when the section is materialized
+        _sectionConstraints[parts.first].emplace_back(index);
+        continue;
+      }
+
+      Section const* found = findSection(parts.first);
+
+      if (found == nullptr) {
+        throw std::logic_error("no section defined for constraint option " +
+                               it);
+      }
+
+      auto section = _sections.find(parts.first);
+
+      if (parts.second == "*") {
+        // options added to the section later are registered as well
+        _sectionConstraints[parts.first].emplace_back(index);
+        for (auto const& it2 : (*section).second.options) {
+          addConstraintOption(it2.second.id, index);
+        }
+        continue;
+      }
+
+      auto option = (*section).second.options.find(parts.second);
+
+      if (option == (*section).second.options.end()) {
+        throw std::logic_error("no option defined for constraint option " +
+                               it);
+      }
+      addConstraintOption((*option).second.id, index);
+    }
+
+    // new constraints are always checked once
+    markConstraint(index);
+  }
+
+  // check all constraints that read options which were set since the last
+  // check. violated constraints are reported and checked again next time,
+  // as they are only resolved by setting one of their options. returns
+  // true if all constraints hold, false otherwise
+  bool checkConstraints() {
+    if (_dirtyConstraints.empty()) {
+      return true;
+    }
+
+    // check in the order the constraints were added
+    std::vector<uint32_t> dirty;
+    dirty.swap(_dirtyConstraints);
+    std::sort(dirty.begin(), dirty.end());
+
+    bool ok = true;
+    for (uint32_t index : dirty) {
+      _constraintDirty[index] = false;
+
+      std::string const result = _constraints[index].check();
+
+      if (!result.empty()) {
+        setContext("option constraints");
+        fail("constraint '" + _constraints[index].description +
+             "' violated: " + result);
+        markConstraint(index);
+        ok = false;
+      }
+    }
+
+    return ok;
+  }
+
+  // adds a listener that is called after a value was set for an option,
+  // e.g. for propagating the new value to other places. throws if the
+  // option does not exist. returns a handle for removing the listener.
+  // listeners may add and remove listeners. a listener added while the
+  // listeners of an option are called is only called for the next value
+  ListenerHandle addChangeListener(std::string const& name,
+                                   ChangeFuncType const& callback) {
+    Option const* option = findOption(name);
+
+    if (option == nullptr) {
+      throw std::logic_error("unknown option '" + name + "'");
+    }
+
+    ListenerHandle const handle{option->id, _nextListenerId++};
+    _listenersByOption[option->id].emplace_back(handle.id, callback);
+    return handle;
+  }
+
+  // removes a change listener, e.g. when the object it updates is
+  // destroyed. the listener is not called anymore, even if it is removed
+  // by another listener of the same option
+  void removeChangeListener(ListenerHandle const& handle) {
+    auto& listeners = _listenersByOption[handle.option];
+    for (auto it = listeners.begin(); it != listeners.end(); ++it) {
+      if ((*it).first == handle.id) {
+        listeners.erase(it);
+        return;
+      }
+    }
+  }
+
   // prints usage information
   void printUsage() const { std::cout << _usage << std::endl << std::endl; }
 
   // prints a help for all options
-  void printHelp(std::string const& section) const {
+  void printHelp(std::string const& section) {
+    if (section == "*") {
+      materializeAll();
+    } else {
+      materializeSection(section);
+    }
+
     printUsage();
 
+    auto const sections = helpSections();
     size_t const tw = _terminalWidth();
-    size_t const ow = optionsWidth();
+    size_t ow = 0;
+    for (auto const& it : sections) {
+      ow = (std::max)(ow, it.second.optionsWidth());
+    }
 
-    for (auto const& it : _sections) {
+    for (auto const& it : sections) {
       if (section == "*" || section == it.second.name) {
         it.second.printHelp(tw, ow);
       }
@@ -152,30 +440,85 @@ class ProgramOptions {
     printSectionsHelp();
   }
 
+  // prints help for the options matching the search terms, ranked by
+  // relevance. the search index is built on first use
+  void printSearchHelp(std::string const& terms) {
+    if (_helpIndex == nullptr) {
+      materializeAll();
+      _helpIndex.reset(new HelpIndex(helpSections()));
+    }
+
+    printUsage();
+
+    auto const options = _helpIndex->search(terms);
+    if (options.empty()) {
+      std::cout << "No options matching '" << terms << "'" << std::endl
+                << std::endl;
+    } else {
+      size_t const tw = _terminalWidth();
+      size_t ow = 0;
+      for (auto const& it : options) {
+        ow = (std::max)(ow, it->optionsWidth());
+      }
+
+      std::cout << "Options matching '" << terms << "'" << std::endl;
+      for (auto const& it : options) {
+        it->printHelp(tw, ow);
+      }
+      std::cout << std::endl;
+    }
+
+    printSectionsHelp();
+  }
+
   // prints the names for all section help options
   void printSectionsHelp() const {
-    // print names of sections
-    std::cout << _more;
-    for (auto const& it : _sections) {
+    // print names of sections, including lazy sections that have not been
+    // registered yet
+    std::set<std::string> names;
+    for (auto const& it : helpSections()) {
       if (!it.second.name.empty() && it.second.hasOptions()) {
-        std::cout << " --help-" << it.second.name;
+        names.emplace(it.second.name);
       }
     }
+    for (auto const& it : _lazySections) {
+      names.emplace(it.first);
+    }
+
+    std::cout << _more;
+    for (auto const& it : names) {
+      std::cout << " --help-" << it;
+    }
     std::cout << std::endl;
   }
 
   // translate a shorthand option
-  std::string translateShorthand(std::string const& name) const {
+  std::string translateShorthand(std::string const& name) {
     auto it = _shorthands.find(name);
 
     if (it == _shorthands.end()) {
-      return name;
+      if (_lazySections.empty()) {
+        return name;
+      }
+      // the shorthand may belong to a lazy section
+      materializeAll();
+      it = _shorthands.find(name);
+      if (it == _shorthands.end()) {
+        return name;
+      }
     }
     return (*it).second;
   }
 
+  // call the callback for all options. this registers the options of all
+  // lazy sections, unless includeLazy is false or only touched options are
+  // requested (touched options are always registered)
   void walk(std::function<void(Section const&, Option const&)> const& callback,
-            bool onlyTouched) {
+            bool onlyTouched, bool includeLazy = true) {
+    if (!onlyTouched && includeLazy) {
+      materializeAll();
+    }
+
     for (auto const& it : _sections) {
       if (it.second.obsolete) {
         // obsolete section. ignore it
@@ -195,19 +538,54 @@ class ProgramOptions {
     }
   }
 
-  // checks whether a specific option exists
-  // if the option does not exist, this will flag an error
-  bool require(std::string const& name) {
+  // returns the option with the given name, or nullptr if it does not exist
+  Option const* findOption(std::string const& name) {
     auto parts = Option::splitName(name);
     auto it = _sections.find(parts.first);
 
     if (it == _sections.end()) {
-      return unknownOption(name);
+      if (!materializeSection(parts.first)) {
+        return nullptr;
+      }
+      it = _sections.find(parts.first);
     }
 
     auto it2 = (*it).second.options.find(parts.second);
 
     if (it2 == (*it).second.options.end()) {
+      return nullptr;
+    }
+
+    return &(*it2).second;
+  }
+
+  // returns the static option with the given name, or nullptr if it does
+  // not exist
+  StaticOption const* findStaticOption(std::string const& name) const {
+    if (_staticSchemas.empty()) {
+      return nullptr;
+    }
+
+    size_t const offset = name.compare(0, 2, "--") == 0 ? 2 : 0;
+    for (auto const& it : _staticSchemas) {
+      StaticOption const* option =
+          it->find(name.data() + offset, name.size() - offset);
+      if (option != nullptr) {
+        return option;
+      }
+    }
+    return nullptr;
+  }
+
+  // checks whether a regular or static option exists
+  bool hasOption(std::string const& name) {
+    return findStaticOption(name) != nullptr || findOption(name) != nullptr;
+  }
+
+  // checks whether a specific option exists
+  // if the option does not exist, this will flag an error
+  bool require(std::string const& name) {
+    if (!hasOption(name)) {
       return unknownOption(name);
     }
 
@@ -216,11 +594,36 @@ class ProgramOptions {
 
   // sets a value for an option
   bool setValue(std::string const& name, std::string const& value) {
+    return setValue(name, value, false);
+  }
+
+  // sets a value for an option. if validated is true, the value has already
+  // been accepted by the parameter's check()
+  bool setValue(std::string const& name, std::string const& value,
+                bool validated) {
+    StaticOption const* staticOption = findStaticOption(name);
+
+    if (staticOption != nullptr) {
+      std::string result = staticOption->set(value);
+
+      if (!result.empty()) {
+        // parameter validation failed
+        return fail("error setting value for option '" + name + "': " +
+                    result);
+      }
+
+      _processingResult.touch(name);
+      return true;
+    }
+
     auto parts = Option::splitName(name);
     auto it = _sections.find(parts.first);
 
     if (it == _sections.end()) {
-      return unknownOption(name);
+      if (!materializeSection(parts.first)) {
+        return unknownOption(name);
+      }
+      it = _sections.find(parts.first);
     }
 
     if ((*it).second.obsolete) {
@@ -241,7 +644,9 @@ class ProgramOptions {
       return true;
     }
 
-    std::string result = option.parameter->set(value);
+    ParameterVariant& parameter = _variants[option.id];
+    std::string result =
+        validated ? parameter.setValidated(value) : parameter.set(value);
 
     if (!result.empty()) {
       // parameter validation failed
@@ -249,48 +654,237 @@ class ProgramOptions {
     }
 
     _processingResult.touch(name);
+    recordValue(option, value);
+    changed(option);
+    return true;
+  }
 
+  // removes all values of a vector option, including its default values
+  bool clearValue(std::string const& name) {
+    if (findStaticOption(name) != nullptr) {
+      return fail("option '" + name + "' does not accept multiple values");
+    }
+
+    Section const* section = findSection(Option::splitName(name).first);
+    if (section != nullptr && section->obsolete) {
+      // section is obsolete. ignore it
+      return true;
+    }
+
+    Option const* option = findOption(name);
+    if (option == nullptr) {
+      return unknownOption(name);
+    }
+    if (option->obsolete) {
+      // option is obsolete. ignore it
+      _processingResult.touch(name);
+      return true;
+    }
+
+    ParameterVariant& parameter = _variants[option->id];
+    if (!parameter.multipleValues()) {
+      return fail("option '" + name + "' does not accept multiple values");
+    }
+
+    parameter.clear();
+    _processingResult.touch(name);
+    forgetValues(*option);
+    changed(*option);
     return true;
   }
 
-  // check whether or not an option requires a value
-  bool requiresValue(std::string const& name) const {
-    auto parts = Option::splitName(name);
-    auto it = _sections.find(parts.first);
+  // get the effective value of an option and the layers that set it
+  // throws if the option does not exist
+  Provenance provenance(std::string const& name) {
+    Option const* option = findOption(name);
 
-    if (it == _sections.end()) {
-      return false;
+    if (option == nullptr) {
+      throw std::logic_error("unknown option '" + name + "'");
     }
 
-    auto it2 = (*it).second.options.find(parts.second);
+    Provenance result;
+    result.value = _variants[option->id].valueString();
+
+    uint32_t index = _latestRecord[option->id];
+    while (index != NoRecord) {
+      ValueRecord const& record = _records[index];
+      result.layers.emplace_back(
+          SourceLocation(record.type, _sourceNames[record.source],
+                         record.position),
+          _recordedValues.substr(record.valueOffset, record.valueLength));
+      index = record.previous;
+    }
 
-    if (it2 == (*it).second.options.end()) {
-      return false;
+    return result;
+  }
+
+  // get the default value of an option in JSON format, as captured when the
+  // option was added
+  std::string const& defaultValue(Option const& option) const {
+    return _defaultValues[option.id];
+  }
+
+  // get the parameter of an option as a variant. calls are dispatched
+  // without virtual calls for the built-in parameter types
+  ParameterVariant const& variant(Option const& option) const {
+    return _variants[option.id];
+  }
+
+  // check whether or not an option requires a value
+  bool requiresValue(std::string const& name) {
+    StaticOption const* staticOption = findStaticOption(name);
+
+    if (staticOption != nullptr) {
+      return staticOption->requiresValue();
     }
 
-    return (*it2).second.parameter->requiresValue();
+    Option const* option = findOption(name);
+
+    return option != nullptr && _variants[option->id].requiresValue();
   }
 
+  // attach a profiler that records reads via get(), or detach it by
+  // passing a nullptr. the profiler must outlive the options
+  void setReadProfiler(ReadProfiler* profiler) { _readProfiler = profiler; }
+
+  // the attached read profiler, nullptr if none
+  ReadProfiler* readProfiler() const { return _readProfiler; }
+
   // returns a pointer to an option, specified by option name
   // returns a nullptr if the option is unknown
+  // the read is recorded for the given call site if a read profiler is
+  // attached, see ARANGODB_PROGRAM_OPTIONS_READ_SITE
   template <typename T>
-  T* get(std::string const& name) {
-    auto parts = Option::splitName(name);
-    auto it = _sections.find(parts.first);
+  T* get(std::string const& name, ReadSite const& site = ReadSite()) {
+    Option const* option = findOption(name);
 
-    if (it == _sections.end()) {
+    if (option == nullptr) {
       return nullptr;
     }
 
-    auto it2 = (*it).second.options.find(parts.second);
+    if (_readProfiler != nullptr) {
+      _readProfiler->record(*option, site);
+    }
 
-    if (it2 == (*it).second.options.end()) {
-      return nullptr;
+    return dynamic_cast<T*>(option->parameter.get());
+  }
+
+  // apply a single token produced by one of the parsers
+  bool apply(Token const& token) {
+    setLocation(token.location);
+
+    switch (token.type) {
+      case Token::Type::Option:
+        return setValue(token.option, token.value);
+      case Token::Type::Positional:
+        return addPositional(token.value);
+      case Token::Type::Clear:
+        return clearValue(token.option);
+      case Token::Type::Unknown:
+        return unknownOption(token.option);
+      case Token::Type::Error:
+        return fail(token.value);
     }
 
-    Option& option = (*it2).second;
+    return false;
+  }
+
+  // apply a batch of tokens in order. stops at the first token that cannot
+  // be applied, exactly like the parsers do.
+  // if the validation concurrency is greater than 1, the values of all
+  // tokens are first checked concurrently via Parameter::check(), and then
+  // set in order without checking them again. the results and the first
+  // error reported are the same as for applying the tokens one by one
+  bool apply(std::vector<Token> const& tokens) {
+    if (_validationPool == nullptr || tokens.size() < 2) {
+      for (auto const& it : tokens) {
+        if (!apply(it)) {
+          return false;
+        }
+      }
+      return true;
+    }
 
-    return dynamic_cast<T>(option.parameter.get());
+    size_t const n = tokens.size();
+
+    // look up the options first. this registers lazy sections, so it
+    // cannot be done concurrently
+    std::vector<Option const*> options(n, nullptr);
+    std::vector<StaticOption const*> staticOptions(n, nullptr);
+    for (size_t i = 0; i < n; ++i) {
+      if (tokens[i].type != Token::Type::Option) {
+        continue;
+      }
+      staticOptions[i] = findStaticOption(tokens[i].option);
+      if (staticOptions[i] == nullptr) {
+        Option const* option = findOption(tokens[i].option);
+        // values of obsolete options and sections are ignored by setValue(),
+        // so they are not checked either
+        if (option != nullptr && !option->obsolete &&
+            !findSection(option->section)->obsolete) {
+          options[i] = option;
+        }
+      }
+    }
+
+    // registering a lazy section may reallocate _variants, so the variants
+    // are only taken once all options have been looked up
+    std::vector<ParameterVariant const*> parameters(n, nullptr);
+    for (size_t i = 0; i < n; ++i) {
+      if (options[i] != nullptr) {
+        parameters[i] = &_variants[options[i]->id];
+      }
+    }
+
+    std::vector<std::string> results(n);
+    _validationPool->run(n, [&tokens, &parameters, &staticOptions,
+                             &results](size_t i) {
+      if (parameters[i] != nullptr) {
+        results[i] = parameters[i]->check(tokens[i].value);
+      } else if (staticOptions[i] != nullptr) {
+        results[i] = staticOptions[i]->check(tokens[i].value);
+      }
+    });
+
+    // set the values in order
+    for (size_t i = 0; i < n; ++i) {
+      Token const& token = tokens[i];
+      if (token.type != Token::Type::Option) {
+        if (!apply(token)) {
+          return false;
+        }
+        continue;
+      }
+
+      setLocation(token.location);
+      if (!results[i].empty()) {
+        // parameter validation failed
+        return fail("error setting value for option '" + token.option +
+                    "': " + results[i]);
+      }
+      if (!setValue(token.option, token.value, parameters[i] != nullptr)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // set the number of threads values are validated with by
+  // apply(std::vector<Token>), and by the parsers using it. values are
+  // validated sequentially while they are set if this is 1 (the default).
+  // with a higher concurrency, the check() functions of all parameters
+  // must be thread-safe
+  void setValidationConcurrency(size_t concurrency) {
+    if (concurrency > 1) {
+      _validationPool.reset(new ThreadPool(concurrency));
+    } else {
+      _validationPool.reset();
+    }
+  }
+
+  // number of threads values are validated with
+  size_t validationConcurrency() const {
+    return _validationPool == nullptr ? 1 : _validationPool->concurrency();
   }
 
   // handle an unknown option
@@ -310,21 +904,40 @@ class ProgramOptions {
 
   // report an error (callback from parser)
   bool fail(std::string const& message) {
-    std::cerr << "Error while processing " << _context << ":" << std::endl;
+    std::cerr << "Error while processing "
+              << (_context.empty() ? _location.context() : _context) << ":"
+              << std::endl;
     std::cerr << "  " << message << std::endl << std::endl;
     _processingResult.failed(true);
     return false;
   }
 
-  // add a positional argument (callback from parser)
-  void addPositional(std::string const& value) {
+  // add a positional argument (callback from parser). returns false if the
+  // positional handler rejected it
+  bool addPositional(std::string const& value) {
+    if (_positionalHandler) {
+      std::string const result = _positionalHandler(value);
+      if (!result.empty()) {
+        return fail(result);
+      }
+      return true;
+    }
     _processingResult._positionals.emplace_back(value);
+    return true;
+  }
+
+  // hand all following positional arguments to handler as they are parsed,
+  // instead of collecting them in ProcessingResult::_positionals. the
+  // argument passed to the handler is only valid during the call. passing
+  // a nullptr restores collecting them
+  void setPositionalHandler(PositionalFuncType const& handler) {
+    _positionalHandler = handler;
   }
 
  private:
   // adds an option to the list of options
   void addOption(Option const& option) {
-    checkIfSealed();
+    checkIfMutable(option.section);
     auto it = _sections.find(option.section);
 
     if (it == _sections.end()) {
@@ -333,6 +946,11 @@ class ProgramOptions {
           option.displayName());
     }
 
+    if (findStaticOption(option.fullName()) != nullptr) {
+      throw std::logic_error(std::string("option already defined: ") +
+                             option.displayName());
+    }
+
     if (!option.shorthand.empty()) {
       if (!_shorthands.emplace(option.shorthand, option.fullName()).second) {
         throw std::logic_error(
@@ -341,16 +959,254 @@ class ProgramOptions {
       }
     }
 
-    (*it).second.options.emplace(option.name, option);
+    auto result = (*it).second.options.emplace(option.name, option);
+
+    if (result.second) {
+      registerOption((*result.first).second);
+    }
   }
 
-  // determine maximum width of all options labels
-  size_t optionsWidth() const {
-    size_t width = 0;
-    for (auto const& it : _sections) {
-      width = (std::max)(width, it.second.optionsWidth());
+  // assign an id to a newly added option and capture its default value
+  void registerOption(Option& option) {
+    option.id = _optionsById.size();
+    _optionsById.emplace_back(&option);
+    _variants.emplace_back(ParameterVariant::of(option.parameter.get()));
+    _latestRecord.emplace_back(NoRecord);
+    _defaultValues.emplace_back();
+    _variants.back().appendJson(_defaultValues.back());
+    _constraintsByOption.emplace_back();
+    _listenersByOption.emplace_back();
+    // the help index does not contain the option yet
+    _helpIndex.reset();
+
+    auto it = _sectionConstraints.find(option.section);
+    if (it != _sectionConstraints.end()) {
+      for (uint32_t index : (*it).second) {
+        addConstraintOption(option.id, index);
+      }
+    }
+  }
+
+  // make a constraint depend on an option
+  void addConstraintOption(size_t id, uint32_t index) {
+    auto& constraints = _constraintsByOption[id];
+    if (constraints.empty() || constraints.back() != index) {
+      constraints.emplace_back(index);
+    }
+  }
+
+  // mark a constraint for checking
+  void markConstraint(uint32_t index) {
+    if (!_constraintDirty[index]) {
+      _constraintDirty[index] = true;
+      _dirtyConstraints.emplace_back(index);
+    }
+  }
+
+  // get the index of a source name, adding it if required
+  uint32_t sourceId(std::string const& name) {
+    auto it = _sourceIds.find(name);
+
+    if (it != _sourceIds.end()) {
+      return (*it).second;
+    }
+
+    uint32_t const id = static_cast<uint32_t>(_sourceNames.size());
+    _sourceNames.emplace_back(name);
+    _sourceIds.emplace(name, id);
+    return id;
+  }
+
+  // notify the constraints and listeners of an option that its value has
+  // changed
+  void changed(Option const& option) {
+    for (uint32_t index : _constraintsByOption[option.id]) {
+      markConstraint(index);
+    }
+
+    if (_listenersByOption[option.id].empty()) {
+      return;
+    }
+
+    // listeners may add or remove listeners, so call them from a copy, and
+    // skip the ones that were removed meanwhile
+    auto const listeners = _listenersByOption[option.id];
+    for (auto const& it : listeners) {
+      if (hasListener(option.id, it.first)) {
+        it.second();
+      }
     }
-    return width;
+  }
+
+  // whether or not a change listener is registered for an option
+  bool hasListener(size_t option, uint64_t id) const {
+    for (auto const& it : _listenersByOption[option]) {
+      if (it.first == id) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // drop the value records of an option, e.g. when its values are cleared
+  void forgetValues(Option const& option) {
+    for (uint32_t index = _latestRecord[option.id]; index != NoRecord;
+         index = _records[index].previous) {
+      ++_droppedRecords;
+    }
+    _latestRecord[option.id] = NoRecord;
+  }
+
+  // record that a value was set for an option
+  void recordValue(Option const& option, std::string const& value) {
+    // keep at most Provenance::MaxLayers records per option. the dropped
+    // record is unlinked here and its storage is reclaimed by compaction
+    uint32_t index = _latestRecord[option.id];
+    for (size_t count = 1; index != NoRecord; ++count) {
+      ValueRecord& record = _records[index];
+      if (count == Provenance::MaxLayers - 1 && record.previous != NoRecord) {
+        record.previous = NoRecord;
+        ++_droppedRecords;
+        break;
+      }
+      index = record.previous;
+    }
+    if ((_droppedRecords > 1024 && _droppedRecords > _records.size() / 2) ||
+        (_droppedRecords > 0 && !fitsRecords(value))) {
+      compactRecords();
+    }
+
+    if (!fitsRecords(value) || _location.position > UINT32_MAX) {
+      throw std::length_error("too many option values recorded");
+    }
+
+    ValueRecord record;
+    record.previous = _latestRecord[option.id];
+    record.source = _locationSourceId;
+    record.position = static_cast<uint32_t>(_location.position);
+    record.valueOffset = static_cast<uint32_t>(_recordedValues.size());
+    record.valueLength = static_cast<uint32_t>(value.size());
+    record.type = _location.type;
+
+    _recordedValues.append(value);
+    _latestRecord[option.id] = static_cast<uint32_t>(_records.size());
+    _records.emplace_back(record);
+  }
+
+  // whether another value can be recorded. offsets and indexes of value
+  // records are 32 bits wide
+  bool fitsRecords(std::string const& value) const {
+    return _records.size() < NoRecord &&
+           value.size() <= UINT32_MAX - _recordedValues.size();
+  }
+
+  // remove the dropped value records and their values
+  void compactRecords() {
+    std::vector<ValueRecord> records;
+    records.reserve(_records.size() - _droppedRecords);
+    std::string values;
+    std::vector<uint32_t> chain;
+
+    for (auto& latest : _latestRecord) {
+      chain.clear();
+      for (uint32_t index = latest; index != NoRecord;
+           index = _records[index].previous) {
+        chain.emplace_back(index);
+      }
+
+      // copy the records of the option, oldest first
+      uint32_t previous = NoRecord;
+      for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        ValueRecord record = _records[*it];
+        record.previous = previous;
+        record.valueOffset = static_cast<uint32_t>(values.size());
+        values.append(_recordedValues, _records[*it].valueOffset,
+                      record.valueLength);
+        previous = static_cast<uint32_t>(records.size());
+        records.emplace_back(record);
+      }
+      latest = previous;
+    }
+
+    _records.swap(records);
+    _recordedValues.swap(values);
+    _droppedRecords = 0;
+  }
+
+  // get all sections for printing help, including the static options
+  std::map<std::string, Section> helpSections() const {
+    if (_staticSchemas.empty()) {
+      return _sections;
+    }
+
+    std::map<std::string, Section> result(_sections);
+    for (auto const& schema : _staticSchemas) {
+      for (size_t i = 0; i < schema->size(); ++i) {
+        Option option = schema->option(i).toOption();
+        auto it = result.find(option.section);
+        if (it == result.end()) {
+          it = result.emplace(option.section,
+                              Section(option.section, option.section, "",
+                                      false, false)).first;
+        }
+        (*it).second.addOption(option);
+      }
+    }
+    return result;
+  }
+
+  // register the options of a lazy section. returns false if there is no
+  // lazy section with this name
+  bool materializeSection(std::string const& name) {
+    auto it = _lazySections.find(name);
+
+    if (it == _lazySections.end()) {
+      return false;
+    }
+
+    SectionProviderFuncType provider = (*it).second;
+    _lazySections.erase(name);
+
+    // providers may reference other lazy sections
+    std::string const* previous = _materializing;
+    _materializing = &name;
+    try {
+      provider(*this);
+    } catch (...) {
+      _materializing = previous;
+      throw;
+    }
+    _materializing = previous;
+
+    if (_sections.find(name) == _sections.end()) {
+      throw std::logic_error("provider for lazy section '" + name +
+                             "' did not add the section");
+    }
+    return true;
+  }
+
+  // register the options of all lazy sections
+  void materializeAll() {
+    while (!_lazySections.empty()) {
+      // copy the name, as materializing removes the entry
+      std::string const name = (*_lazySections.begin()).first;
+      materializeSection(name);
+    }
+  }
+
+  // check if a section can be modified. while a lazy section is
+  // materialized, only that section can be modified, even if the options
+  // are sealed
+  void checkIfMutable(std::string const& section) const {
+    if (_materializing != nullptr) {
+      if (section != *_materializing) {
+        throw std::logic_error("provider for lazy section '" +
+                               *_materializing +
+                               "' must only add options to that section");
+      }
+      return;
+    }
+    checkIfSealed();
   }
 
   // check if the options are already sealed and throw if yes
@@ -375,6 +1231,14 @@ class ProgramOptions {
                             option.displayName());
         }
       }, false);
+      for (auto const& schema : _staticSchemas) {
+        for (size_t i = 0; i < schema->size(); ++i) {
+          std::string const name(schema->option(i).name);
+          if (name != value) {
+            distances.emplace(_similarity(value, name), "--" + name);
+          }
+        }
+      }
 
       // now return the ones that have an edit distance not higher than the
       // cutOff value
@@ -398,6 +1262,33 @@ class ProgramOptions {
   }
 
  private:
+  // a single value assignment, recorded for provenance tracking
+  struct ValueRecord {
+    // index of the previous record for the same option, or NoRecord
+    uint32_t previous;
+    // index of the source name in _sourceNames
+    uint32_t source;
+    // argv index or line number
+    uint32_t position;
+    // the value, stored in _recordedValues
+    uint32_t valueOffset;
+    uint32_t valueLength;
+    SourceType type;
+  };
+  static_assert(sizeof(ValueRecord) == 24, "value records should be compact");
+
+  // a constraint between options
+  struct Constraint {
+    Constraint(std::string const& description, ConstraintFuncType const& check)
+        : description(description), check(check) {}
+
+    std::string description;
+    ConstraintFuncType check;
+  };
+
+  // marker for "no record"
+  enum : uint32_t { NoRecord = UINT32_MAX };
+
   // name of binary (i.e. argv[0])
   std::string _progname;
   // usage hint, e.g. "usage: #progname# [<options>] ..."
@@ -406,6 +1297,11 @@ class ProgramOptions {
   std::string _more;
   // context string that's shown when errors are printed
   std::string _context;
+  // source location that's shown when errors are printed and no context
+  // string is set. also recorded for each value set
+  SourceLocation _location;
+  // index of _location.name in _sourceNames
+  uint32_t _locationSourceId;
   // all sections
   std::map<std::string, Section> _sections;
   // shorthands for options, translating from short options to long option names
@@ -419,6 +1315,54 @@ class ProgramOptions {
   ProcessingResult _processingResult;
   // whether or not the program options setup is still mutable
   bool _sealed;
+  // profiler for option reads, nullptr if none
+  ReadProfiler* _readProfiler;
+  // consumer for positional arguments, if they are not collected
+  PositionalFuncType _positionalHandler;
+  // static schemas
+  std::vector<StaticSchemaBase const*> _staticSchemas;
+  // providers of lazy sections that have not been registered yet
+  std::map<std::string, SectionProviderFuncType> _lazySections;
+  // name of the lazy section currently being registered, nullptr if none
+  std::string const* _materializing;
+  // all options, indexed by option id
+  std::vector<Option*> _optionsById;
+  // parameters of all options as variants, indexed by option id
+  std::vector<ParameterVariant> _variants;
+  // default values of all options in JSON format, by option id
+  std::vector<std::string> _defaultValues;
+  // index of the most recent value record for each option, by option id
+  std::vector<uint32_t> _latestRecord;
+  // all value records, grouped by option after compaction
+  std::vector<ValueRecord> _records;
+  // the recorded values, concatenated
+  std::string _recordedValues;
+  // number of records in _records that are no longer linked
+  size_t _droppedRecords;
+  // names of all sources values were set from, e.g. config file names
+  std::vector<std::string> _sourceNames;
+  // index of each source name in _sourceNames
+  std::unordered_map<std::string, uint32_t> _sourceIds;
+  // all constraints, in the order they were added
+  std::vector<Constraint> _constraints;
+  // indexes of the constraints reading each option, by option id
+  std::vector<std::vector<uint32_t>> _constraintsByOption;
+  // indexes of the constraints reading all options of a section
+  std::unordered_map<std::string, std::vector<uint32_t>> _sectionConstraints;
+  // whether or not each constraint needs to be checked
+  std::vector<bool> _constraintDirty;
+  // indexes of the constraints that need to be checked
+  std::vector<uint32_t> _dirtyConstraints;
+  // change listeners, by option id
+  std::vector<std::vector<std::pair<uint64_t, ChangeFuncType>>>
+      _listenersByOption;
+  // id of the next change listener
+  uint64_t _nextListenerId;
+  // index for searching the help, built on first use
+  std::unique_ptr<HelpIndex> _helpIndex;
+  // threads for validating values concurrently, nullptr if values are
+  // validated sequentially
+  std::unique_ptr<ThreadPool> _validationPool;
 };
 }
 }
@@ -0,0 +1,227 @@
+#ifndef ARANGODB_PROGRAM_OPTIONS_READ_PROFILER_H
+#define ARANGODB_PROGRAM_OPTIONS_READ_PROFILER_H 1
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+#include <thread>
+
+#include "Option.h"
+
+// the call site of an option read, for use with ProgramOptions::get()
+#define ARANGODB_PROGRAM_OPTIONS_READ_SITE \
+  ::arangodb::options::ReadSite(__FILE__, __LINE__)
+
+namespace arangodb {
+namespace options {
+
+// source location of an option read
+struct ReadSite {
+  ReadSite() : file(nullptr), line(0) {}
+  ReadSite(char const* file, int line) : file(file), line(line) {}
+
+  // file name, nullptr if unknown. must be a string literal
+  char const* file;
+  int line;
+};
+
+// sampling profiler for option reads
+// reads are counted in per-thread shards, so that profiled reads from many
+// threads do not contend with each other. the shards are only merged when
+// a report is requested. a profiler is attached to the options via
+// ProgramOptions::setReadProfiler(). without a profiler, reads only pay for
+// a nullptr check, and while the profiler is disabled, for a relaxed load
+class ReadProfiler {
+ public:
+  // read count of a single call site
+  struct SiteCount {
+    SiteCount(std::string const& file, int line, uint64_t count)
+        : file(file), line(line), count(count) {}
+
+    std::string file;
+    int line;
+    uint64_t count;
+  };
+
+  // read count of an option, together with the sites that read it
+  struct OptionCount {
+    OptionCount(std::string const& option, uint64_t count)
+        : option(option), count(count) {}
+
+    std::string option;
+    // estimated number of reads
+    uint64_t count;
+    // call sites, sorted by read count (highest first)
+    std::vector<SiteCount> sites;
+  };
+
+  // no need to copy this
+  ReadProfiler(ReadProfiler const&) = delete;
+  ReadProfiler& operator=(ReadProfiler const&) = delete;
+
+  // create a profiler that records one out of sampleInterval reads per
+  // thread. the profiler starts enabled
+  explicit ReadProfiler(uint32_t sampleInterval = 1)
+      : _serial(nextSerial()),
+        _sampleInterval(sampleInterval == 0 ? 1 : sampleInterval),
+        _enabled(true) {}
+
+  // enable or disable recording
+  void enabled(bool value) { _enabled.store(value, std::memory_order_relaxed); }
+
+  // whether or not recording is enabled
+  bool enabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+  // record a read of an option
+  void record(Option const& option, ReadSite const& site) {
+    if (!_enabled.load(std::memory_order_relaxed)) {
+      return;
+    }
+
+    Shard& shard = localShard();
+    if (++shard.tick < _sampleInterval) {
+      return;
+    }
+    shard.tick = 0;
+
+    std::lock_guard<std::mutex> guard(shard.mutex);
+    ++shard.counts[Key(&option, site)];
+  }
+
+  // merge the counts of all threads and rank the options by read count
+  // (highest first). counts are scaled by the sample interval
+  std::vector<OptionCount> report() const {
+    std::map<Option const*, std::map<std::pair<std::string, int>, uint64_t>>
+        merged;
+
+    {
+      std::lock_guard<std::mutex> guard(_shardsMutex);
+      for (auto const& shard : _shards) {
+        std::lock_guard<std::mutex> shardGuard(shard->mutex);
+        for (auto const& it : shard->counts) {
+          std::string file(it.first.file == nullptr ? "" : it.first.file);
+          merged[it.first.option][std::make_pair(file, it.first.line)] +=
+              it.second * _sampleInterval;
+        }
+      }
+    }
+
+    std::vector<OptionCount> result;
+    for (auto const& it : merged) {
+      result.emplace_back(it.first->fullName(), 0);
+      OptionCount& count = result.back();
+      for (auto const& it2 : it.second) {
+        count.count += it2.second;
+        count.sites.emplace_back(it2.first.first, it2.first.second,
+                                 it2.second);
+      }
+      std::stable_sort(count.sites.begin(), count.sites.end(),
+                       [](SiteCount const& lhs, SiteCount const& rhs) {
+                         return lhs.count > rhs.count;
+                       });
+    }
+
+    std::stable_sort(result.begin(), result.end(),
+                     [](OptionCount const& lhs, OptionCount const& rhs) {
+                       return lhs.count > rhs.count;
+                     });
+    return result;
+  }
+
+  // discard all counts
+  void reset() {
+    std::lock_guard<std::mutex> guard(_shardsMutex);
+    for (auto const& shard : _shards) {
+      std::lock_guard<std::mutex> shardGuard(shard->mutex);
+      shard->counts.clear();
+    }
+  }
+
+ private:
+  // counter key: option and call site
+  struct Key {
+    Key(Option const* option, ReadSite const& site)
+        : option(option), file(site.file), line(site.line) {}
+
+    // pointers to unrelated objects are only totally ordered by std::less
+    bool operator<(Key const& other) const {
+      std::less<void const*> less;
+      if (option != other.option) {
+        return less(option, other.option);
+      }
+      if (file != other.file) {
+        return less(file, other.file);
+      }
+      return line < other.line;
+    }
+
+    Option const* option;
+    char const* file;
+    int line;
+  };
+
+  // counters of a single thread. the mutex is only contended while a
+  // report is built
+  struct Shard {
+    Shard() : tick(0) {}
+
+    uint32_t tick;
+    std::mutex mutex;
+    std::map<Key, uint64_t> counts;
+  };
+
+  // get the shard of the calling thread, creating it if required
+  Shard& localShard() {
+    // cache for the most recently used profiler. profilers are identified
+    // by serial number, as a new profiler may reuse the address of a
+    // destroyed one
+    static thread_local uint64_t cachedSerial = 0;
+    static thread_local Shard* cachedShard = nullptr;
+
+    if (cachedSerial == _serial) {
+      return *cachedShard;
+    }
+
+    std::lock_guard<std::mutex> guard(_shardsMutex);
+    auto it = _threadShards.find(std::this_thread::get_id());
+    Shard* shard;
+    if (it == _threadShards.end()) {
+      _shards.emplace_back(new Shard());
+      shard = _shards.back().get();
+      _threadShards.emplace(std::this_thread::get_id(), shard);
+    } else {
+      shard = (*it).second;
+    }
+    cachedSerial = _serial;
+    cachedShard = shard;
+    return *shard;
+  }
+
+  static uint64_t nextSerial() {
+    static std::atomic<uint64_t> serial(0);
+    return ++serial;
+  }
+
+  // serial number of the profiler
+  uint64_t const _serial;
+  // record one out of this many reads per thread
+  uint32_t const _sampleInterval;
+  // whether or not recording is enabled
+  std::atomic<bool> _enabled;
+  // protects _shards and _threadShards
+  mutable std::mutex _shardsMutex;
+  // shards of all threads that have recorded reads
+  std::vector<std::unique_ptr<Shard>> _shards;
+  // shard of each thread
+  std::map<std::thread::id, Shard*> _threadShards;
+};
+}
+}
+
+#endif
@@ -0,0 +1,188 @@
+#ifndef ARANGODB_PROGRAM_OPTIONS_RESPONSE_FILE_H
+#define ARANGODB_PROGRAM_OPTIONS_RESPONSE_FILE_H 1
+
+#include <string>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <stdlib.h>
+#else
+#include <limits.h>
+#endif
+
+namespace arangodb {
+namespace options {
+
+// streaming reader for response files, i.e. files containing command-line
+// arguments. arguments are separated by whitespace (including newlines).
+// single quotes preserve everything up to the next single quote, double
+// quotes group whitespace, and outside of single quotes a backslash makes
+// the following character literal. the file is read in blocks, and
+// arguments are produced one at a time
+class ResponseFile {
+ public:
+  // result of reading the next argument
+  enum class Result { Argument, End, Error };
+
+  // no need to copy this
+  ResponseFile(ResponseFile const&) = delete;
+  ResponseFile& operator=(ResponseFile const&) = delete;
+
+  ResponseFile(std::string const& name, std::string const& path)
+      : _name(name),
+        _path(path),
+        _stream(name, std::ifstream::in | std::ifstream::binary),
+        _position(0),
+        _length(0),
+        _line(1),
+        _argumentLine(0) {}
+
+  // name of the file, as it was opened
+  std::string const& name() const { return _name; }
+
+  // canonical path of the file
+  std::string const& path() const { return _path; }
+
+  // whether or not the file could be opened
+  bool isOpen() const { return _stream.is_open(); }
+
+  // line number of the argument read last
+  size_t line() const { return _argumentLine; }
+
+  // read the next argument. on error, argument contains the error message
+  Result next(std::string& argument) {
+    argument.clear();
+
+    int c;
+    // skip whitespace
+    do {
+      c = get();
+    } while (c != EOF && isWhitespace(c));
+
+    if (c == EOF) {
+      return Result::End;
+    }
+
+    _argumentLine = _line;
+
+    while (c != EOF && !isWhitespace(c)) {
+      if (c == '\'') {
+        while ((c = get()) != '\'') {
+          if (c == EOF) {
+            argument = "unterminated quote in response file";
+            return Result::Error;
+          }
+          argument.push_back(static_cast<char>(c));
+        }
+      } else if (c == '"') {
+        while ((c = get()) != '"') {
+          if (c == '\\') {
+            c = get();
+          }
+          if (c == EOF) {
+            argument = "unterminated quote in response file";
+            return Result::Error;
+          }
+          argument.push_back(static_cast<char>(c));
+        }
+      } else if (c == '\\') {
+        c = get();
+        argument.push_back(static_cast<char>(c == EOF ? '\\' : c));
+        if (c == EOF) {
+          break;
+        }
+      } else {
+        argument.push_back(static_cast<char>(c));
+      }
+      c = get();
+    }
+
+    return Result::Argument;
+  }
+
+  // resolve the name of a response file referenced from another response
+  // file. relative names are resolved against the directory of the
+  // referencing file
+  static std::string resolve(std::string const& name,
+                             ResponseFile const* parent) {
+    if (parent == nullptr) {
+      return name;
+    }
+    return resolve(name, parent->name());
+  }
+
+  // resolve the name of a file referenced from the file parent. relative
+  // names are resolved against the directory of parent
+  static std::string resolve(std::string const& name,
+                             std::string const& parent) {
+    if (name.empty() || name[0] == '/' || name[0] == '\\' ||
+        (name.size() > 1 && name[1] == ':')) {
+      return name;
+    }
+    size_t const pos = parent.find_last_of("/\\");
+    if (pos == std::string::npos) {
+      return name;
+    }
+    return parent.substr(0, pos + 1) + name;
+  }
+
+  // get the canonical path of a file, or an empty string if it does not
+  // exist
+  static std::string canonicalPath(std::string const& name) {
+#ifdef _WIN32
+    char buffer[_MAX_PATH];
+    if (_fullpath(buffer, name.c_str(), _MAX_PATH) == nullptr) {
+      return "";
+    }
+    return buffer;
+#else
+    char buffer[PATH_MAX];
+    if (realpath(name.c_str(), buffer) == nullptr) {
+      return "";
+    }
+    return buffer;
+#endif
+  }
+
+ private:
+  static bool isWhitespace(int c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+  }
+
+  // get the next character from the file, EOF at the end
+  int get() {
+    if (_position == _length) {
+      if (!_stream.good()) {
+        return EOF;
+      }
+      _stream.read(_buffer, sizeof(_buffer));
+      _length = static_cast<size_t>(_stream.gcount());
+      _position = 0;
+      if (_length == 0) {
+        return EOF;
+      }
+    }
+    char const c = _buffer[_position++];
+    if (c == '\n') {
+      ++_line;
+    }
+    return static_cast<unsigned char>(c);
+  }
+
+  std::string const _name;
+  std::string const _path;
+  std::ifstream _stream;
+  char _buffer[65536];
+  size_t _position;
+  size_t _length;
+  // current line number
+  size_t _line;
+  // line number of the argument read last
+  size_t _argumentLine;
+};
+}
+}
+
+#endif
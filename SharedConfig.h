@@ -0,0 +1,606 @@
+#ifndef ARANGODB_PROGRAM_OPTIONS_SHARED_CONFIG_H
+#define ARANGODB_PROGRAM_OPTIONS_SHARED_CONFIG_H 1
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <limits>
+#include <type_traits>
+
+#ifndef _WIN32
+#include <atomic>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#endif
+
+#include "Parameters.h"
+#include "ProgramOptions.h"
+
+namespace arangodb {
+namespace options {
+
+// read-only shared-memory copy of the resolved configuration
+// a process that has processed all options exports the option schema and
+// the effective values into a shared-memory segment. other processes, e.g.
+// forked or exec'd workers that inherit the file descriptor, attach to the
+// segment and read option values from it without any parsing.
+// the segment only contains offsets, so it can be mapped at any address.
+// layout: a Header, followed by the OptionEntry table sorted by full option
+// name, the ValueEntry table, and the strings all offsets point into.
+// values are stored in the format Parameter::set() accepts, one per value
+// of a vector option. values of the built-in boolean, integer and double
+// types are additionally stored in binary, so they can be read via get()
+// without parsing them. static options (see
+// ProgramOptions::addStaticSchema()) are not exported
+// only supported on POSIX systems. create() and attach() return false
+// elsewhere
+class SharedConfig {
+ public:
+  // no need to copy this
+  SharedConfig(SharedConfig const&) = delete;
+  SharedConfig& operator=(SharedConfig const&) = delete;
+
+  SharedConfig() : _fd(-1), _data(nullptr), _size(0) {}
+
+  ~SharedConfig() { close(); }
+
+  // export the options and their current values into a new segment. the
+  // options must be sealed. the file descriptor of the segment is inherited
+  // by child processes, so they can attach to it via fd(). returns true if
+  // all is well, false otherwise
+  bool create(ProgramOptions* options) {
+    if (!options->sealed()) {
+      throw std::logic_error(
+          "program options must be sealed before exporting them");
+    }
+
+    std::string buffer;
+    build(options, buffer);
+
+    close();
+
+#ifndef _WIN32
+    int fd = -1;
+#if defined(__linux__) && defined(SYS_memfd_create)
+    // MFD_ALLOW_SEALING
+    fd = static_cast<int>(
+        ::syscall(SYS_memfd_create, "program-options", 2U));
+#endif
+    if (fd == -1) {
+      // no memfd. fall back to an unlinked POSIX shared memory object
+      static std::atomic<uint32_t> counter(0);
+      char name[64];
+      snprintf(name, sizeof(name), "/program-options-%ld-%u",
+               static_cast<long>(::getpid()),
+               static_cast<unsigned>(counter.fetch_add(1)));
+      fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+      if (fd == -1) {
+        return false;
+      }
+      ::shm_unlink(name);
+    }
+
+    if (::ftruncate(fd, static_cast<off_t>(buffer.size())) != 0 ||
+        !writeAll(fd, buffer)) {
+      ::close(fd);
+      return false;
+    }
+
+#ifdef F_ADD_SEALS
+    // make the segment immutable. fails for shared memory objects, which
+    // are still only mapped read-only
+    ::fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE |
+                                 F_SEAL_SEAL);
+#endif
+
+    if (!attach(fd)) {
+      ::close(fd);
+      return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  // attach to a segment created by another process. the file descriptor is
+  // owned by this object afterwards. returns true if all is well, false if
+  // the segment cannot be mapped or is not a valid segment
+  bool attach(int fd) {
+    close();
+
+#ifndef _WIN32
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < 0 ||
+        static_cast<uint64_t>(st.st_size) < sizeof(Header)) {
+      return false;
+    }
+
+    size_t const size = static_cast<size_t>(st.st_size);
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+      return false;
+    }
+
+    if (!validate(static_cast<char const*>(data), size)) {
+      ::munmap(data, size);
+      return false;
+    }
+
+    _fd = fd;
+    _data = static_cast<char const*>(data);
+    _size = size;
+    return true;
+#else
+    (void)fd;
+    return false;
+#endif
+  }
+
+  // detach from the segment
+  void close() {
+#ifndef _WIN32
+    if (_data != nullptr) {
+      ::munmap(const_cast<char*>(_data), _size);
+    }
+    if (_fd != -1) {
+      ::close(_fd);
+    }
+#endif
+    _fd = -1;
+    _data = nullptr;
+    _size = 0;
+  }
+
+  // file descriptor of the segment, -1 if not attached
+  int fd() const { return _fd; }
+
+  // size of the segment in bytes
+  size_t size() const { return _size; }
+
+  // number of options in the segment
+  size_t optionCount() const {
+    return _data == nullptr ? 0 : header()->optionCount;
+  }
+
+  // whether or not an option exists
+  bool has(std::string const& name) const { return find(name) != nullptr; }
+
+  // type description of an option, empty if the option does not exist
+  std::string typeDescription(std::string const& name) const {
+    OptionEntry const* entry = find(name);
+    if (entry == nullptr) {
+      return "";
+    }
+    return std::string(_data + entry->typeOffset, entry->typeLength);
+  }
+
+  // number of values of an option, i.e. the number of elements for vector
+  // options. 0 if the option does not exist or is an unset flag
+  size_t valueCount(std::string const& name) const {
+    OptionEntry const* entry = find(name);
+    return entry == nullptr ? 0 : entry->valueCount;
+  }
+
+  // get a value of an option without copying it. returns false if the
+  // option or the value does not exist
+  bool value(std::string const& name, size_t index, char const*& data,
+             size_t& length) const {
+    OptionEntry const* entry = find(name);
+    if (entry == nullptr || index >= entry->valueCount) {
+      return false;
+    }
+    ValueEntry const& value = values()[entry->firstValue + index];
+    data = _data + value.offset;
+    length = value.length;
+    return true;
+  }
+
+  // get a value of an option, empty if it does not exist
+  std::string value(std::string const& name, size_t index = 0) const {
+    char const* data;
+    size_t length;
+    if (!value(name, index, data, length)) {
+      return "";
+    }
+    return std::string(data, length);
+  }
+
+  // get a value of an option in binary, as converted by the exporting
+  // process. T can be bool for boolean options, an integer type for integer
+  // options, double for double options, and std::string for string options.
+  // unset flags are read as false. returns false if the option or the value
+  // does not exist, if the option has a different type, or if the value
+  // does not fit into T
+  template <typename T>
+  bool get(std::string const& name, T& result, size_t index = 0) const {
+    OptionEntry const* entry = find(name);
+    if (entry == nullptr) {
+      return false;
+    }
+    ValueType const type = static_cast<ValueType>(entry->valueType);
+    if (index >= entry->valueCount) {
+      // a flag that is not set has no value
+      return type == ValueType::Boolean && entry->valueCount == 0 &&
+             index == 0 && convert(type, 0, result);
+    }
+    ValueEntry const& value = values()[entry->firstValue + index];
+    if (type == ValueType::String) {
+      return convert(_data + value.offset, value.length, result);
+    }
+    return convert(type, value.bits, result);
+  }
+
+ private:
+  // types of the values of an option
+  enum class ValueType : uint32_t {
+    // custom parameter types, only stored as text
+    Text,
+    Boolean,
+    Signed,
+    Unsigned,
+    Double,
+    String
+  };
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t optionCount;
+    uint32_t valueCount;
+    uint32_t size;
+  };
+
+  struct OptionEntry {
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t typeOffset;
+    uint32_t typeLength;
+    uint32_t firstValue;
+    uint32_t valueCount;
+    // a ValueType
+    uint32_t valueType;
+    uint32_t padding;
+  };
+
+  struct ValueEntry {
+    // the value as text
+    uint32_t offset;
+    uint32_t length;
+    // the bits of the value, for booleans (0 or 1), integers (as int64_t or
+    // uint64_t) and doubles
+    uint64_t bits;
+  };
+
+  // the tables must keep the ValueEntry table aligned
+  static_assert(sizeof(OptionEntry) == 32 && sizeof(ValueEntry) == 16 &&
+                    sizeof(Header) % 8 == 0,
+                "unexpected segment layout");
+
+  enum : uint32_t { Version = 2 };
+
+  static char const* magic() { return "POPTSHM"; }
+
+  Header const* header() const {
+    return reinterpret_cast<Header const*>(_data);
+  }
+
+  OptionEntry const* entries() const {
+    return reinterpret_cast<OptionEntry const*>(_data + sizeof(Header));
+  }
+
+  ValueEntry const* values() const {
+    return reinterpret_cast<ValueEntry const*>(
+        _data + sizeof(Header) + header()->optionCount * sizeof(OptionEntry));
+  }
+
+  // binary search for an option
+  OptionEntry const* find(std::string const& name) const {
+    if (_data == nullptr) {
+      return nullptr;
+    }
+
+    std::string const key = Option::stripPrefix(name);
+    OptionEntry const* begin = entries();
+    OptionEntry const* end = begin + header()->optionCount;
+
+    auto it = std::lower_bound(begin, end, key, [this](OptionEntry const& entry,
+                                                       std::string const& key) {
+      return compare(entry, key) < 0;
+    });
+
+    if (it == end || compare(*it, key) != 0) {
+      return nullptr;
+    }
+    return it;
+  }
+
+  // compare the name of an option with a key
+  int compare(OptionEntry const& entry, std::string const& key) const {
+    size_t const n = (std::min)(static_cast<size_t>(entry.nameLength),
+                                key.size());
+    int const result = memcmp(_data + entry.nameOffset, key.data(), n);
+    if (result != 0) {
+      return result;
+    }
+    if (entry.nameLength == key.size()) {
+      return 0;
+    }
+    return entry.nameLength < key.size() ? -1 : 1;
+  }
+
+  // convert a binary value
+  static bool convert(ValueType type, uint64_t bits, bool& result) {
+    if (type != ValueType::Boolean) {
+      return false;
+    }
+    result = bits != 0;
+    return true;
+  }
+
+  template <typename T>
+  static typename std::enable_if<
+      std::is_integral<T>::value && !std::is_same<T, bool>::value, bool>::type
+  convert(ValueType type, uint64_t bits, T& result) {
+    if (type == ValueType::Signed) {
+      int64_t const value = static_cast<int64_t>(bits);
+      if ((std::is_signed<T>::value &&
+           value < static_cast<int64_t>(std::numeric_limits<T>::min())) ||
+          (!std::is_signed<T>::value && value < 0) ||
+          (value > 0 && static_cast<uint64_t>(value) >
+                            static_cast<uint64_t>(
+                                std::numeric_limits<T>::max()))) {
+        return false;
+      }
+      result = static_cast<T>(value);
+      return true;
+    }
+    if (type == ValueType::Unsigned) {
+      if (bits > static_cast<uint64_t>(std::numeric_limits<T>::max())) {
+        return false;
+      }
+      result = static_cast<T>(bits);
+      return true;
+    }
+    return false;
+  }
+
+  static bool convert(ValueType type, uint64_t bits, double& result) {
+    if (type != ValueType::Double) {
+      return false;
+    }
+    memcpy(&result, &bits, sizeof(result));
+    return true;
+  }
+
+  static bool convert(ValueType, uint64_t, std::string&) { return false; }
+
+  // convert a string value
+  static bool convert(char const* data, size_t length, std::string& result) {
+    result.assign(data, length);
+    return true;
+  }
+
+  template <typename T>
+  static bool convert(char const*, size_t, T&) {
+    return false;
+  }
+
+  // the value type of a parameter
+  static ValueType valueType(ParameterVariant const& parameter) {
+    switch (parameter.type()) {
+      case VariantType::Boolean:
+      case VariantType::Flag:
+        return ValueType::Boolean;
+      case VariantType::Int16:
+      case VariantType::Int32:
+      case VariantType::Int64:
+        return ValueType::Signed;
+      case VariantType::UInt16:
+      case VariantType::UInt32:
+      case VariantType::UInt64:
+        return ValueType::Unsigned;
+      case VariantType::Double:
+        return ValueType::Double;
+      case VariantType::String:
+        return ValueType::String;
+      case VariantType::Custom:
+        break;
+    }
+    return ValueType::Text;
+  }
+
+  // convert a value from its text form into binary. the text was produced
+  // by the parameter, so it is always valid
+  static uint64_t toBits(ValueType type, std::string const& value) {
+    switch (type) {
+      case ValueType::Boolean:
+        return value == "true" ? 1 : 0;
+      case ValueType::Signed:
+        return static_cast<uint64_t>(toNumber<int64_t>(value));
+      case ValueType::Unsigned:
+        return toNumber<uint64_t>(value);
+      case ValueType::Double: {
+        double const number = toNumber<double>(value);
+        uint64_t bits;
+        memcpy(&bits, &number, sizeof(bits));
+        return bits;
+      }
+      case ValueType::Text:
+      case ValueType::String:
+        break;
+    }
+    return 0;
+  }
+
+  // serialize the options into the segment layout
+  static void build(ProgramOptions* options, std::string& buffer) {
+    struct Item {
+      std::string name;
+      std::string type;
+      ValueType valueType;
+      std::vector<std::string> values;
+    };
+
+    std::vector<Item> items;
+    size_t valueCount = 0;
+    options->walk([&items, &valueCount, options](Section const&,
+                                                 Option const& option) {
+      ParameterVariant const& parameter = options->variant(option);
+      items.emplace_back();
+      Item& item = items.back();
+      item.name = option.fullName();
+      item.type = option.parameter->typeDescription();
+      item.valueType = valueType(parameter);
+      size_t const n = parameter.valueCount();
+      for (size_t i = 0; i < n; ++i) {
+        item.values.emplace_back();
+        parameter.appendValue(item.values.back(), i);
+      }
+      valueCount += n;
+    }, false);
+
+    std::sort(items.begin(), items.end(), [](Item const& lhs, Item const& rhs) {
+      return lhs.name < rhs.name;
+    });
+
+    size_t const tables = sizeof(Header) + items.size() * sizeof(OptionEntry) +
+                          valueCount * sizeof(ValueEntry);
+    std::vector<OptionEntry> entries;
+    std::vector<ValueEntry> values;
+    std::string strings;
+
+    auto addString = [tables, &strings](std::string const& value) {
+      uint32_t const offset = static_cast<uint32_t>(tables + strings.size());
+      strings.append(value);
+      return offset;
+    };
+
+    for (auto const& it : items) {
+      OptionEntry entry;
+      entry.nameOffset = addString(it.name);
+      entry.nameLength = static_cast<uint32_t>(it.name.size());
+      entry.typeOffset = addString(it.type);
+      entry.typeLength = static_cast<uint32_t>(it.type.size());
+      entry.firstValue = static_cast<uint32_t>(values.size());
+      entry.valueCount = static_cast<uint32_t>(it.values.size());
+      entry.valueType = static_cast<uint32_t>(it.valueType);
+      entry.padding = 0;
+      entries.emplace_back(entry);
+
+      for (auto const& it2 : it.values) {
+        ValueEntry value;
+        value.offset = addString(it2);
+        value.length = static_cast<uint32_t>(it2.size());
+        value.bits = toBits(it.valueType, it2);
+        values.emplace_back(value);
+      }
+    }
+
+    if (tables + strings.size() > UINT32_MAX) {
+      throw std::length_error("configuration too big for shared memory");
+    }
+
+    Header header;
+    memcpy(header.magic, magic(), sizeof(header.magic));
+    header.version = Version;
+    header.optionCount = static_cast<uint32_t>(entries.size());
+    header.valueCount = static_cast<uint32_t>(values.size());
+    header.size = static_cast<uint32_t>(tables + strings.size());
+
+    buffer.clear();
+    buffer.reserve(header.size);
+    buffer.append(reinterpret_cast<char const*>(&header), sizeof(header));
+    if (!entries.empty()) {
+      buffer.append(reinterpret_cast<char const*>(entries.data()),
+                    entries.size() * sizeof(OptionEntry));
+    }
+    if (!values.empty()) {
+      buffer.append(reinterpret_cast<char const*>(values.data()),
+                    values.size() * sizeof(ValueEntry));
+    }
+    buffer.append(strings);
+  }
+
+  // check that a mapped segment is complete and consistent, so that no
+  // lookup can read outside of it
+  static bool validate(char const* data, size_t size) {
+    Header const* header = reinterpret_cast<Header const*>(data);
+    if (memcmp(header->magic, magic(), sizeof(header->magic)) != 0 ||
+        header->version != Version || header->size != size) {
+      return false;
+    }
+
+    uint64_t const tables =
+        sizeof(Header) +
+        static_cast<uint64_t>(header->optionCount) * sizeof(OptionEntry) +
+        static_cast<uint64_t>(header->valueCount) * sizeof(ValueEntry);
+    if (tables > size) {
+      return false;
+    }
+
+    auto inside = [size](uint32_t offset, uint32_t length) {
+      return static_cast<uint64_t>(offset) + length <= size;
+    };
+
+    OptionEntry const* entries =
+        reinterpret_cast<OptionEntry const*>(data + sizeof(Header));
+    ValueEntry const* values = reinterpret_cast<ValueEntry const*>(
+        data + sizeof(Header) + header->optionCount * sizeof(OptionEntry));
+
+    for (uint32_t i = 0; i < header->optionCount; ++i) {
+      OptionEntry const& entry = entries[i];
+      if (!inside(entry.nameOffset, entry.nameLength) ||
+          !inside(entry.typeOffset, entry.typeLength) ||
+          static_cast<uint64_t>(entry.firstValue) + entry.valueCount >
+              header->valueCount ||
+          entry.valueType > static_cast<uint32_t>(ValueType::String)) {
+        return false;
+      }
+    }
+
+    for (uint32_t i = 0; i < header->valueCount; ++i) {
+      if (!inside(values[i].offset, values[i].length)) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+#ifndef _WIN32
+  // write the buffer to the start of the file
+  static bool writeAll(int fd, std::string const& buffer) {
+    size_t written = 0;
+    while (written < buffer.size()) {
+      ssize_t const n = ::pwrite(fd, buffer.data() + written,
+                                 buffer.size() - written,
+                                 static_cast<off_t>(written));
+      if (n <= 0) {
+        return false;
+      }
+      written += static_cast<size_t>(n);
+    }
+    return true;
+  }
+#endif
+
+  // file descriptor of the segment
+  int _fd;
+  // start of the mapped segment
+  char const* _data;
+  // size of the mapped segment
+  size_t _size;
+};
+}
+}
+
+#endif
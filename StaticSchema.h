@@ -0,0 +1,378 @@
+#ifndef ARANGODB_PROGRAM_OPTIONS_STATIC_SCHEMA_H
+#define ARANGODB_PROGRAM_OPTIONS_STATIC_SCHEMA_H 1
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+
+#include "Option.h"
+#include "Parameters.h"
+
+namespace arangodb {
+namespace options {
+
+// value types of static options
+enum class StaticType {
+  Boolean,
+  Flag,
+  Int32,
+  Int64,
+  UInt32,
+  UInt64,
+  Double,
+  String
+};
+
+// definition of an option that is known at compile time
+// static options are defined in constexpr arrays, e.g.
+//   static uint64_t threads = 4;
+//   static constexpr StaticOption schema[] = {
+//     {"server.threads", "number of threads", &threads}};
+// the name is the full option name, i.e. "section.name"
+struct StaticOption {
+  // length of a name, usable in constant expressions
+  static constexpr size_t lengthOf(char const* name) {
+    return *name == '\0' ? 0 : 1 + lengthOf(name + 1);
+  }
+
+  constexpr StaticOption(char const* name, char const* description,
+                         bool* target, bool requiresValue = true)
+      : name(name),
+        nameLength(lengthOf(name)),
+        description(description),
+        type(requiresValue ? StaticType::Boolean : StaticType::Flag),
+        target(target) {}
+
+  constexpr StaticOption(char const* name, char const* description,
+                         int32_t* target)
+      : name(name),
+        nameLength(lengthOf(name)),
+        description(description),
+        type(StaticType::Int32),
+        target(target) {}
+
+  constexpr StaticOption(char const* name, char const* description,
+                         int64_t* target)
+      : name(name),
+        nameLength(lengthOf(name)),
+        description(description),
+        type(StaticType::Int64),
+        target(target) {}
+
+  constexpr StaticOption(char const* name, char const* description,
+                         uint32_t* target)
+      : name(name),
+        nameLength(lengthOf(name)),
+        description(description),
+        type(StaticType::UInt32),
+        target(target) {}
+
+  constexpr StaticOption(char const* name, char const* description,
+                         uint64_t* target)
+      : name(name),
+        nameLength(lengthOf(name)),
+        description(description),
+        type(StaticType::UInt64),
+        target(target) {}
+
+  constexpr StaticOption(char const* name, char const* description,
+                         double* target)
+      : name(name),
+        nameLength(lengthOf(name)),
+        description(description),
+        type(StaticType::Double),
+        target(target) {}
+
+  constexpr StaticOption(char const* name, char const* description,
+                         std::string* target)
+      : name(name),
+        nameLength(lengthOf(name)),
+        description(description),
+        type(StaticType::String),
+        target(target) {}
+
+  // whether or not the option requires a value
+  bool requiresValue() const { return type != StaticType::Flag; }
+
+  // set the value of the option. returns an error message, or an empty
+  // string if all is well. uses the regular parameter types for validation,
+  // without allocating them
+  std::string set(std::string const& value) const {
+    return variant().set(value);
+  }
+
+  // check whether a value would be accepted by set(), without setting it
+  std::string check(std::string const& value) const {
+    return variant().check(value);
+  }
+
+  // the parameter of the option as a variant
+  ParameterVariant variant() const {
+    switch (type) {
+      case StaticType::Boolean:
+      case StaticType::Flag:
+        return ParameterVariant(static_cast<bool*>(target),
+                                type == StaticType::Boolean);
+      case StaticType::Int32:
+        return ParameterVariant(static_cast<int32_t*>(target));
+      case StaticType::Int64:
+        return ParameterVariant(static_cast<int64_t*>(target));
+      case StaticType::UInt32:
+        return ParameterVariant(static_cast<uint32_t*>(target));
+      case StaticType::UInt64:
+        return ParameterVariant(static_cast<uint64_t*>(target));
+      case StaticType::Double:
+        return ParameterVariant(static_cast<double*>(target));
+      case StaticType::String:
+        break;
+    }
+    return ParameterVariant(static_cast<std::string*>(target));
+  }
+
+  // create a regular option for the static option, e.g. for printing help
+  Option toOption() const {
+    Parameter* parameter = nullptr;
+    switch (type) {
+      case StaticType::Boolean:
+      case StaticType::Flag:
+        parameter = new BooleanParameter(static_cast<bool*>(target),
+                                         type == StaticType::Boolean);
+        break;
+      case StaticType::Int32:
+        parameter = new Int32Parameter(static_cast<int32_t*>(target));
+        break;
+      case StaticType::Int64:
+        parameter = new Int64Parameter(static_cast<int64_t*>(target));
+        break;
+      case StaticType::UInt32:
+        parameter = new UInt32Parameter(static_cast<uint32_t*>(target));
+        break;
+      case StaticType::UInt64:
+        parameter = new UInt64Parameter(static_cast<uint64_t*>(target));
+        break;
+      case StaticType::Double:
+        parameter = new DoubleParameter(static_cast<double*>(target));
+        break;
+      case StaticType::String:
+        parameter = new StringParameter(static_cast<std::string*>(target));
+        break;
+    }
+    return Option(name, description, parameter, false, false);
+  }
+
+  char const* name;
+  // length of the name, computed when the option is defined
+  size_t nameLength;
+  char const* description;
+  StaticType type;
+  // the variable the option value is stored in
+  void* target;
+};
+
+// interface for static schemas, used by ProgramOptions
+class StaticSchemaBase {
+ public:
+  virtual ~StaticSchemaBase() {}
+
+  // find an option by full name. returns a nullptr if the option does not
+  // exist
+  virtual StaticOption const* find(char const* name, size_t length) const = 0;
+
+  // number of options in the schema
+  virtual size_t size() const = 0;
+
+  // the option with the given index
+  virtual StaticOption const& option(size_t index) const = 0;
+
+  StaticOption const* find(std::string const& name) const {
+    return find(name.data(), name.size());
+  }
+};
+
+// lookup structure for a fixed set of static options
+// the options are looked up via a minimal perfect hash over their full
+// names (hash and displace): the hash of a name selects a bucket, the seed
+// stored for the bucket selects the slot, and the slot contains the index
+// of the only option that can match. a lookup thus costs one hash, two
+// table reads and one length and memory comparison, regardless of the
+// number of options. the tables are built once, when the schema is
+// constructed: C++11 constexpr functions cannot contain loops, so the
+// search for the seeds cannot run at compile time. the tables themselves
+// have a fixed size, so lookups never touch the heap
+template <size_t N>
+class StaticSchema : public StaticSchemaBase {
+  static_assert(N > 0, "static schema must not be empty");
+
+ public:
+  // number of buckets. on average, a bucket contains two options
+  enum : size_t { Buckets = (N + 1) / 2 };
+
+  // no need to copy this
+  StaticSchema(StaticSchema const&) = delete;
+  StaticSchema& operator=(StaticSchema const&) = delete;
+
+  // build the lookup tables. throws if an option is defined twice
+  explicit StaticSchema(StaticOption const (&options)[N]) : _options(options) {
+    build();
+  }
+
+  using StaticSchemaBase::find;
+
+  StaticOption const* find(char const* name, size_t length) const override {
+    uint64_t const hash = Option::stableId(name, length);
+    StaticOption const& option =
+        _options[_slots[slot(hash, _seeds[hash % Buckets])]];
+
+    // the name looked up may contain NUL bytes, so compare by length first
+    if (option.nameLength != length ||
+        memcmp(option.name, name, length) != 0) {
+      return nullptr;
+    }
+    return &option;
+  }
+
+  size_t size() const override { return N; }
+
+  StaticOption const& option(size_t index) const override {
+    return _options[index];
+  }
+
+  // get a pointer to the variable of an option, or a nullptr if the option
+  // does not exist or its variable is not of type T
+  template <typename T>
+  T* get(std::string const& name) const {
+    StaticOption const* option = find(name);
+    if (option == nullptr || !matches(static_cast<T*>(nullptr), option->type)) {
+      return nullptr;
+    }
+    return static_cast<T*>(option->target);
+  }
+
+ private:
+  // map a hash and a seed to a slot
+  static size_t slot(uint64_t hash, uint32_t seed) {
+    // murmur3 finalizer
+    uint64_t h = hash + seed * 0x9e3779b97f4a7c15ULL;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return static_cast<size_t>(h % N);
+  }
+
+  void build() {
+    // the temporary tables are allocated, so that large schemas do not
+    // overflow the stack
+    std::vector<uint64_t> hashes(N);
+    // option indexes, grouped by bucket
+    std::vector<uint32_t> members(N);
+    // start of each bucket in members
+    std::vector<uint32_t> starts(Buckets + 1, 0);
+    // buckets, in the order they are processed
+    std::vector<uint32_t> order(Buckets);
+    std::vector<bool> used(N, false);
+    std::vector<size_t> positions(N);
+
+    for (size_t i = 0; i < N; ++i) {
+      hashes[i] = Option::stableId(_options[i].name, _options[i].nameLength);
+      ++starts[hashes[i] % Buckets + 1];
+    }
+    for (size_t i = 0; i < Buckets; ++i) {
+      starts[i + 1] += starts[i];
+      order[i] = static_cast<uint32_t>(i);
+    }
+    {
+      std::vector<uint32_t> next(starts.begin(), starts.end() - 1);
+      for (size_t i = 0; i < N; ++i) {
+        members[next[hashes[i] % Buckets]++] = static_cast<uint32_t>(i);
+      }
+    }
+
+    // place the biggest buckets first, while most slots are still free
+    std::sort(order.begin(), order.end(), [&starts](uint32_t lhs,
+                                                    uint32_t rhs) {
+      return starts[lhs + 1] - starts[lhs] > starts[rhs + 1] - starts[rhs];
+    });
+
+    for (size_t b = 0; b < Buckets; ++b) {
+      uint32_t const bucket = order[b];
+      uint32_t const begin = starts[bucket];
+      uint32_t const end = starts[bucket + 1];
+
+      for (uint32_t i = begin; i < end; ++i) {
+        for (uint32_t j = begin; j < i; ++j) {
+          if (hashes[members[i]] == hashes[members[j]]) {
+            StaticOption const& lhs = _options[members[i]];
+            StaticOption const& rhs = _options[members[j]];
+            if (lhs.nameLength == rhs.nameLength &&
+                memcmp(lhs.name, rhs.name, lhs.nameLength) == 0) {
+              throw std::logic_error(
+                  std::string("static option defined twice: ") +
+                  std::string(lhs.name, lhs.nameLength));
+            }
+            throw std::logic_error("stable option id collision");
+          }
+        }
+      }
+
+      uint32_t seed = 0;
+      while (true) {
+        bool ok = true;
+        for (uint32_t i = begin; i < end && ok; ++i) {
+          positions[i - begin] = slot(hashes[members[i]], seed);
+          ok = !used[positions[i - begin]];
+          for (uint32_t j = begin; j < i && ok; ++j) {
+            ok = positions[j - begin] != positions[i - begin];
+          }
+        }
+        if (ok) {
+          break;
+        }
+        ++seed;
+      }
+
+      _seeds[bucket] = seed;
+      for (uint32_t i = begin; i < end; ++i) {
+        used[positions[i - begin]] = true;
+        _slots[positions[i - begin]] = members[i];
+      }
+    }
+  }
+
+  static bool matches(bool*, StaticType type) {
+    return type == StaticType::Boolean || type == StaticType::Flag;
+  }
+  static bool matches(int32_t*, StaticType type) {
+    return type == StaticType::Int32;
+  }
+  static bool matches(int64_t*, StaticType type) {
+    return type == StaticType::Int64;
+  }
+  static bool matches(uint32_t*, StaticType type) {
+    return type == StaticType::UInt32;
+  }
+  static bool matches(uint64_t*, StaticType type) {
+    return type == StaticType::UInt64;
+  }
+  static bool matches(double*, StaticType type) {
+    return type == StaticType::Double;
+  }
+  static bool matches(std::string*, StaticType type) {
+    return type == StaticType::String;
+  }
+
+  // the option definitions
+  StaticOption const* _options;
+  // seed of each bucket
+  uint32_t _seeds[Buckets];
+  // option index of each slot
+  uint32_t _slots[N];
+};
+}
+}
+
+#endif
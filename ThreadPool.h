@@ -0,0 +1,177 @@
+#ifndef ARANGODB_PROGRAM_OPTIONS_THREAD_POOL_H
+#define ARANGODB_PROGRAM_OPTIONS_THREAD_POOL_H 1
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace arangodb {
+namespace options {
+
+// a minimal pool of worker threads for running index-based batches of work
+// the pool is used by the parsers for processing independent inputs in
+// parallel. results are always combined by the caller in input order, so
+// the order in which the pool processes items does not matter
+class ThreadPool {
+ public:
+  // function type for a batch item. it is called with the item index
+  typedef std::function<void(size_t)> WorkFuncType;
+
+  // no need to copy this
+  ThreadPool(ThreadPool const&) = delete;
+  ThreadPool& operator=(ThreadPool const&) = delete;
+
+  // create a pool with the given concurrency. the calling thread of run()
+  // counts as one of the threads, so concurrency - 1 threads are started
+  explicit ThreadPool(size_t concurrency)
+      : _concurrency(concurrency == 0 ? 1 : concurrency),
+        _work(nullptr),
+        _count(0),
+        _next(0),
+        _active(0),
+        _generation(0),
+        _stop(false) {
+    for (size_t i = 1; i < _concurrency; ++i) {
+      _threads.emplace_back([this]() { workerLoop(); });
+    }
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> guard(_mutex);
+      _stop = true;
+    }
+    _wakeup.notify_all();
+    for (auto& it : _threads) {
+      it.join();
+    }
+  }
+
+  // the default concurrency, i.e. the number of hardware threads
+  static size_t defaultConcurrency() {
+    size_t const n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+  }
+
+  // number of threads that process items, including the calling thread
+  size_t concurrency() const { return _concurrency; }
+
+  // call work(i) for all i in [0, count) and wait until all calls have
+  // returned. if any call throws, the first exception is rethrown here
+  // after all other items have been processed. run() must not be called
+  // concurrently or from within a work function
+  void run(size_t count, WorkFuncType const& work) {
+    if (count == 0) {
+      return;
+    }
+
+    if (_threads.empty() || count == 1) {
+      for (size_t i = 0; i < count; ++i) {
+        work(i);
+      }
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> guard(_mutex);
+      _work = &work;
+      _count = count;
+      _next = 0;
+      _active = _threads.size();
+      _error = nullptr;
+      ++_generation;
+    }
+    _wakeup.notify_all();
+
+    process(work, count);
+
+    std::unique_lock<std::mutex> guard(_mutex);
+    _done.wait(guard, [this]() { return _active == 0; });
+    _work = nullptr;
+
+    if (_error != nullptr) {
+      std::exception_ptr error = _error;
+      _error = nullptr;
+      std::rethrow_exception(error);
+    }
+  }
+
+ private:
+  // process items until there are none left
+  void process(WorkFuncType const& work, size_t count) {
+    while (true) {
+      size_t const i = _next.fetch_add(1, std::memory_order_relaxed);
+      if (i >= count) {
+        break;
+      }
+      try {
+        work(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> guard(_mutex);
+        if (_error == nullptr) {
+          _error = std::current_exception();
+        }
+      }
+    }
+  }
+
+  void workerLoop() {
+    uint64_t seen = 0;
+    while (true) {
+      WorkFuncType const* work;
+      size_t count;
+      {
+        std::unique_lock<std::mutex> guard(_mutex);
+        _wakeup.wait(guard,
+                     [this, seen]() { return _stop || _generation != seen; });
+        if (_stop) {
+          return;
+        }
+        seen = _generation;
+        work = _work;
+        count = _count;
+      }
+
+      process(*work, count);
+
+      std::lock_guard<std::mutex> guard(_mutex);
+      if (--_active == 0) {
+        _done.notify_one();
+      }
+    }
+  }
+
+  // number of threads processing items, including the calling thread
+  size_t const _concurrency;
+  // worker threads
+  std::vector<std::thread> _threads;
+  // protects all of the following members, except _next
+  std::mutex _mutex;
+  // signaled when a new batch is available or the pool is shut down
+  std::condition_variable _wakeup;
+  // signaled when the last worker has finished the current batch
+  std::condition_variable _done;
+  // work function of the current batch
+  WorkFuncType const* _work;
+  // number of items in the current batch
+  size_t _count;
+  // index of the next item to process
+  std::atomic<size_t> _next;
+  // number of workers still busy with the current batch
+  size_t _active;
+  // batch counter, used for waking up the workers
+  uint64_t _generation;
+  // first exception thrown by a work function of the current batch
+  std::exception_ptr _error;
+  // whether or not the pool is shutting down
+  bool _stop;
+};
+}
+}
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef ARANGODB_PROGRAM_OPTIONS_TOKEN_H
+#define ARANGODB_PROGRAM_OPTIONS_TOKEN_H 1
+
+#include <string>
+
+namespace arangodb {
+namespace options {
+
+// types of sources option values can come from
+enum class SourceType {
+  Unknown,
+  CommandLine,
+  ConfigFile,
+  Environment,
+  ResponseFile
+};
+
+// location of a token inside its source
+struct SourceLocation {
+  SourceLocation() : type(SourceType::Unknown), position(0) {}
+
+  SourceLocation(SourceType type, std::string const& name, size_t position)
+      : type(type), name(name), position(position) {}
+
+  // build the context string used in error messages
+  std::string context() const {
+    switch (type) {
+      case SourceType::CommandLine:
+        return "command-line options";
+      case SourceType::ConfigFile:
+        if (position == 0) {
+          return "config file '" + name + "'";
+        }
+        return "config file '" + name + "', line #" + std::to_string(position);
+      case SourceType::ResponseFile:
+        return "response file '" + name + "', line #" + std::to_string(position);
+      case SourceType::Environment:
+        return "environment variable '" + name + "'";
+      case SourceType::Unknown:
+        break;
+    }
+    return "";
+  }
+
+  // type of the source
+  SourceType type;
+  // name of the source, e.g. the name of the config file, response file or
+  // environment variable. empty for the command line
+  std::string name;
+  // argv index for command-line options, line number for config files and
+  // response files
+  size_t position;
+};
+
+// a resolved token produced by one of the parsers
+// tokens can be inspected, filtered or rewritten before they are applied
+// via ProgramOptions::apply()
+struct Token {
+  enum class Type {
+    // an option with a value. the option name is fully qualified, i.e.
+    // shorthands are translated and config file sections are prepended
+    Option,
+    // a positional argument, stored in value
+    Positional,
+    // removal of all values of a vector option, including its default
+    // values. the option name is fully qualified like for Option
+    Clear,
+    // an option that does not exist. applying it reports the option as
+    // unknown, including suggestions for similar options
+    Unknown,
+    // a parse error. the error message is stored in value
+    Error
+  };
+
+  Token() : type(Type::Option) {}
+
+  Type type;
+  std::string option;
+  std::string value;
+  SourceLocation location;
+};
+}
+}
+
+#endif
@@ -0,0 +1,153 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <atomic>
+#include <cstdint>
+
+#include "ArgumentParser.h"
+#include "Parameters.h"
+#include "ProgramOptions.h"
+
+using namespace arangodb::options;
+
+// checks that positional arguments are passed to the positional handler
+// while the arguments are parsed, also if values are validated concurrently
+// usage: argument_parser_test
+// the exit code is 1 if any check fails
+
+namespace {
+
+size_t failures = 0;
+
+void check(bool condition, std::string const& what) {
+  if (!condition) {
+    ++failures;
+    std::cout << "check failed: " << what << std::endl;
+  }
+}
+
+// number of values checked so far
+std::atomic<size_t> checked(0);
+
+// a parameter that counts how often its values are checked
+struct CountingParameter : public Parameter {
+  explicit CountingParameter(std::string* ptr) : ptr(ptr) {}
+
+  std::string name() const override { return "string"; }
+  std::string valueString() const override { return stringifyValue(*ptr); }
+  std::string set(std::string const& value) override {
+    std::string result = check(value);
+    if (result.empty()) {
+      *ptr = value;
+    }
+    return result;
+  }
+  std::string check(std::string const& value) const override {
+    ++checked;
+    return value == "invalid" ? "invalid value" : "";
+  }
+  std::string setValidated(std::string const& value) override {
+    *ptr = value;
+    return "";
+  }
+
+  std::string* ptr;
+};
+
+// a positional argument as seen by the handler
+struct Call {
+  std::string argument;
+  // the option value when the handler was called
+  std::string value;
+  // the number of values checked when the handler was called
+  size_t checked;
+};
+
+// parse the arguments and record the handler calls
+bool parse(std::vector<std::string> const& arguments, size_t concurrency,
+           std::vector<Call>& calls, std::string& value) {
+  ProgramOptions options("argument_parser_test", "", "",
+                         []() { return size_t(80); }, nullptr);
+  options.addSection("test", "");
+  options.addOption("--test.value", "", new CountingParameter(&value));
+  options.seal();
+  options.setValidationConcurrency(concurrency);
+  options.setPositionalHandler([&calls, &value](std::string const& argument) {
+    calls.push_back(Call{argument, value, checked.load()});
+    return argument == "reject" ? std::string("rejected") : std::string();
+  });
+
+  std::vector<char*> argv;
+  std::string program("argument_parser_test");
+  argv.push_back(&program[0]);
+  std::vector<std::string> copies(arguments);
+  for (auto& it : copies) {
+    argv.push_back(&it[0]);
+  }
+  argv.push_back(nullptr);
+
+  checked = 0;
+  return ArgumentParser(&options).parse(static_cast<int>(arguments.size() + 1),
+                                        argv.data());
+}
+}
+
+int main() {
+  // many options between the positionals. with concurrent validation, the
+  // options are applied in batches, but a positional must not wait for
+  // the options that follow it
+  std::vector<std::string> arguments;
+  arguments.push_back("first");
+  for (size_t i = 0; i < 3000; ++i) {
+    arguments.push_back("--test.value");
+    arguments.push_back("a" + std::to_string(i));
+    if (i == 99) {
+      arguments.push_back("second");
+    }
+  }
+  arguments.push_back("third");
+
+  for (size_t concurrency : {1, 4}) {
+    std::string const label =
+        " (concurrency " + std::to_string(concurrency) + ")";
+    std::vector<Call> calls;
+    std::string value;
+    check(parse(arguments, concurrency, calls, value), "parse" + label);
+    check(calls.size() == 3, "all positionals passed" + label);
+    if (calls.size() == 3) {
+      check(calls[0].argument == "first" && calls[0].value.empty() &&
+                calls[0].checked == 0,
+            "first positional before any option" + label);
+      check(calls[1].argument == "second" && calls[1].value == "a99" &&
+                calls[1].checked == 100,
+            "second positional after 100 options" + label);
+      check(calls[2].argument == "third" && calls[2].value == "a2999" &&
+                calls[2].checked == 3000,
+            "third positional after all options" + label);
+    }
+    check(value == "a2999", "last value wins" + label);
+  }
+
+  // errors stop parsing, before or after a positional
+  for (size_t concurrency : {1, 4}) {
+    std::string const label =
+        " (concurrency " + std::to_string(concurrency) + ")";
+    std::vector<Call> calls;
+    std::string value;
+    check(!parse({"--test.value", "invalid", "first"}, concurrency, calls,
+                 value),
+          "invalid value fails" + label);
+    check(calls.empty(), "no positional after invalid value" + label);
+
+    calls.clear();
+    check(!parse({"reject", "--test.value", "a", "second"}, concurrency,
+                 calls, value),
+          "rejected positional fails" + label);
+    check(calls.size() == 1 && value.empty(),
+          "nothing applied after rejected positional" + label);
+  }
+
+  std::cout << failures << " failures" << std::endl;
+
+  return failures == 0 ? 0 : 1;
+}
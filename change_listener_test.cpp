@@ -0,0 +1,104 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <cstdint>
+#include <memory>
+
+#include "HotValue.h"
+#include "Parameters.h"
+#include "ProgramOptions.h"
+
+using namespace arangodb::options;
+
+// checks that change listeners can add and remove listeners while they are
+// called, and that hot values follow the option value
+// usage: change_listener_test
+// the exit code is 1 if any check fails
+
+namespace {
+
+size_t failures = 0;
+
+void check(bool condition, std::string const& what) {
+  if (!condition) {
+    ++failures;
+    std::cout << "check failed: " << what << std::endl;
+  }
+}
+
+struct Setup {
+  Setup()
+      : options("change_listener_test", "", "", []() { return size_t(80); },
+                nullptr),
+        value(1) {
+    options.addSection("server", "");
+    options.addOption("--server.threads", "", new UInt64Parameter(&value));
+    options.seal();
+  }
+
+  ProgramOptions options;
+  uint64_t value;
+};
+}
+
+int main() {
+  // a listener removing itself and another listener
+  {
+    Setup setup;
+    std::vector<int> calls;
+    ProgramOptions::ListenerHandle first;
+    ProgramOptions::ListenerHandle second;
+    first = setup.options.addChangeListener("server.threads", [&]() {
+      calls.push_back(1);
+      setup.options.removeChangeListener(first);
+      setup.options.removeChangeListener(second);
+    });
+    second = setup.options.addChangeListener(
+        "server.threads", [&calls]() { calls.push_back(2); });
+
+    check(setup.options.setValue("server.threads", "2"), "set value");
+    check(setup.options.setValue("server.threads", "3"), "set value again");
+    check(calls == std::vector<int>({1}), "removed listeners not called");
+  }
+
+  // a listener adding listeners
+  {
+    Setup setup;
+    size_t added = 0;
+    size_t called = 0;
+    setup.options.addChangeListener("server.threads", [&]() {
+      for (size_t i = 0; i < 100; ++i) {
+        setup.options.addChangeListener("server.threads",
+                                        [&called]() { ++called; });
+        ++added;
+      }
+    });
+
+    check(setup.options.setValue("server.threads", "2"), "set value");
+    check(called == 0, "added listeners called for the next value only");
+    check(setup.options.setValue("server.threads", "3"), "set value again");
+    check(called == 100, "added listeners called");
+    check(added == 200, "adding listener called twice");
+  }
+
+  // a listener destroying a hot value
+  {
+    Setup setup;
+    std::unique_ptr<HotValue<uint64_t>> hot(
+        new HotValue<uint64_t>(&setup.options, "server.threads", &setup.value));
+    check(hot->get() == 1, "initial hot value");
+    check(setup.options.setValue("server.threads", "5"), "set value");
+    check(hot->get() == 5, "hot value updated");
+
+    setup.options.addChangeListener("server.threads", [&hot]() {
+      hot.reset();
+    });
+    check(setup.options.setValue("server.threads", "6"), "set value again");
+    check(hot == nullptr, "hot value destroyed");
+    check(setup.options.setValue("server.threads", "7"), "set value after");
+  }
+
+  std::cout << failures << " failures" << std::endl;
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,188 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdint>
+
+#include "ConfigValidator.h"
+#include "ConfigWriter.h"
+#include "ExampleOptions.h"
+#include "IniFileParser.h"
+#include "Parameters.h"
+#include "ProgramOptions.h"
+
+using namespace arangodb::options;
+
+// checks that the ini output of ConfigWriter parses back to identical
+// values, including vector options with default values and custom
+// parameter types
+// usage: config_writer_test
+// the exit code is 1 if any check fails
+
+namespace {
+
+size_t failures = 0;
+
+void check(bool condition, std::string const& what) {
+  if (!condition) {
+    ++failures;
+    std::cout << "check failed: " << what << std::endl;
+  }
+}
+
+// a custom parameter type that only implements valueString(), which
+// quotes the value like StringParameter does
+struct PathParameter : public Parameter {
+  explicit PathParameter(std::string* ptr) : ptr(ptr) {}
+
+  std::string name() const override { return "path"; }
+  std::string valueString() const override { return stringifyValue(*ptr); }
+  std::string set(std::string const& value) override {
+    *ptr = value;
+    return "";
+  }
+
+  std::string* ptr;
+};
+
+// the example options, plus some more types
+struct Setup {
+  Setup()
+      : options("config_writer_test", "", "", []() { return size_t(80); },
+                nullptr),
+        path("/var/lib/default"),
+        doubles({0.1, 2.5}) {
+    addExampleOptions(options, values);
+    options.addSection("extra", "");
+    options.addOption("--extra.path", "", new PathParameter(&path));
+    options.addOption("--extra.doubles", "",
+                      new VectorParameter<DoubleParameter>(&doubles));
+    options.addOption("--extra.engines", "",
+                      new VectorParameter<DiscreteValuesParameter<StorageEngine>>(
+                          &engines, {{"mmfiles", StorageEngine::MMFiles},
+                                     {"rocksdb", StorageEngine::RocksDB}}));
+    options.seal();
+  }
+
+  std::string ini() {
+    std::string out;
+    ConfigWriter(&options).writeIni(out, false);
+    return out;
+  }
+
+  std::string json() {
+    std::string out;
+    ConfigWriter(&options).writeJson(out, false);
+    return out;
+  }
+
+  ProgramOptions options;
+  ExampleOptions values;
+  std::string path;
+  std::vector<double> doubles;
+  std::vector<StorageEngine> engines;
+};
+
+// parse ini text from a stream
+bool parseStream(Setup& setup, std::string const& text) {
+  std::istringstream in(text);
+  return IniFileParser(&setup.options).parse(in, "stream");
+}
+
+// write ini text to a file and parse it with the given concurrency
+bool parseFile(Setup& setup, std::string const& text, size_t concurrency,
+               bool multiple) {
+  std::string const filename = "config_writer_test.ini";
+  std::ofstream(filename) << text;
+  setup.options.setValidationConcurrency(concurrency);
+  IniFileParser parser(&setup.options);
+  bool const result = multiple
+                          ? parser.parse(std::vector<std::string>{filename})
+                          : parser.parse(filename);
+  std::remove(filename.c_str());
+  return result;
+}
+}
+
+int main() {
+  // values that differ from the defaults. vectors are replaced, appended to
+  // and emptied
+  std::string const input =
+      "[server]\n"
+      "@clear endpoints\n"
+      "endpoints = tcp://[::1]:8529\n"
+      "endpoints = \"quoted\"\n"
+      "@clear ports\n"
+      "storage-engine = mmfiles\n"
+      "[extra]\n"
+      "path = /data/with = sign\n"
+      "doubles = 0.30000000000000004\n"
+      "@clear engines\n"
+      "engines = rocksdb\n";
+
+  Setup original;
+  check(parseStream(original, input), "parse input");
+  check(original.values.endpoints ==
+            std::vector<std::string>({"tcp://[::1]:8529", "\"quoted\""}),
+        "cleared vector");
+  check(original.values.ports.empty(), "emptied vector");
+  check(original.doubles.size() == 3, "appended vector");
+
+  std::string const ini = original.ini();
+  std::string const json = original.json();
+
+  // stream parser
+  {
+    Setup copy;
+    check(parseStream(copy, ini), "parse output");
+    check(copy.json() == json, "round trip (stream)");
+    check(copy.ini() == ini, "ini output (stream)");
+    check(copy.path == original.path, "custom type");
+  }
+
+  // file parsers, sequential and with concurrent validation
+  for (size_t concurrency : {1, 4}) {
+    for (bool multiple : {false, true}) {
+      Setup copy;
+      check(parseFile(copy, ini, concurrency, multiple), "parse file");
+      check(copy.json() == json,
+            "round trip (concurrency " + std::to_string(concurrency) +
+                (multiple ? ", multiple files)" : ")"));
+    }
+  }
+
+  // token stream
+  {
+    Setup copy;
+    std::istringstream in(ini);
+    IniFileParser::Tokenizer tokenizer(in, "stream");
+    Token token;
+    bool ok = true;
+    while (tokenizer.next(token)) {
+      ok &= copy.options.apply(token);
+    }
+    check(ok && copy.json() == json, "round trip (tokens)");
+  }
+
+  // clearing an option that does not accept multiple values is an error
+  {
+    Setup setup;
+    check(!parseStream(setup, "[server]\n@clear int32-value\n"),
+          "clear scalar fails");
+    check(!parseStream(setup, "@clear\n"), "clear without name fails");
+
+    std::string const filename = "config_writer_test.ini";
+    std::ofstream(filename) << ini << "[database]\n@clear journal-size\n";
+    auto result = ConfigValidator(&setup.options).validate(filename);
+    std::remove(filename.c_str());
+    check(result.errors.size() == 1 && result.errors[0].option ==
+                                           "database.journal-size",
+          "validator reports clear of scalar");
+  }
+
+  std::cout << failures << " failures" << std::endl;
+
+  return failures == 0 ? 0 : 1;
+}
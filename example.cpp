@@ -6,6 +6,8 @@
 #include <numeric>
 
 #include "ArgumentParser.h"
+#include "EnvironmentParser.h"
+#include "ExampleOptions.h"
 #include "IniFileParser.h"
 #include "Option.h"
 #include "Parameters.h"
@@ -19,32 +21,6 @@
 
 using namespace arangodb::options;
 
-// a custom parameter type for port numbers
-struct PortParameter : public Parameter {
-  typedef uint32_t ValueType;
-
-  explicit PortParameter(ValueType* ptr) : ptr(ptr) {}
-
-  std::string name() const override { return "port number"; }
-
-  std::string valueString() const override { return std::to_string(*ptr); }
-
-  std::string set(std::string const& value) override {
-    try {
-      uint32_t v = static_cast<uint32_t>(std::stoull(value));
-      if (v >= 1024 && v <= 65535) {
-        *ptr = std::stoull(value);
-        return "";
-      }
-    } catch (...) {
-      return "invalid numeric value";
-    }
-    return "number out of range (port number must be between 1024 and 65535)";
-  }
-
-  ValueType* ptr;
-};
-
 // callback function for calculating the similarity of two string values
 static int similarityFunc(std::string const& lhs, std::string const& rhs) {
   int const lhsLength = static_cast<int>(lhs.size());
@@ -93,18 +69,7 @@ static int terminalWidthFunc() {
 
 int main(int argc, char* argv[]) {
   // destination variables for option values
-  std::string configFile;
-  std::vector<std::string> endpoints = {"tcp://127.0.0.1:80",
-                                        "ssl://192.168.0.1:443"};
-  std::vector<uint32_t> ports = {8529, 16384};
-  uint32_t journalSize = 16 * 1024 * 1024;
-  bool quiet = false;
-  bool noServer = false;
-  bool waitForSync = false;
-  bool crashMe = false;
-  int32_t int32 = 1;
-  uint32_t uint32 = 0;
-  uint32_t bounded = 99;
+  ExampleOptions values;
 
   // set up program options
   ProgramOptions options(argv[0], "Usage: " ARANGODB_PROGRAM_OPTIONS_PROGNAME
@@ -112,51 +77,8 @@ int main(int argc, char* argv[]) {
                          "For more information use:", terminalWidthFunc,
                          similarityFunc);
 
-  // set up some basic sections
-
-  // global (unnamed section)
-  options.addSection(Section("", "Global options description goes here",
-                             "global options", false, false));
-  options.addOption("--quiet,-q", "tell the server to be quiet",
-                    new BooleanParameter(&quiet, false));
-  options.addOption("--no-server", "don't start server at all",
-                    new BooleanParameter(&noServer, false));
-  options.addOption("--configuration,-c", "parse configuration file",
-                    new StringParameter(&configFile));
-  options.addOption("--version", "prints version information",
-                    new ObsoleteParameter());
-
-  // "server" options section
-  options.addSection("server", "Server options description goes here");
-  options.addOption("--server.endpoints,-e", "server endpoints",
-                    new VectorParameter<StringParameter>(&endpoints));
-  options.addOption("--server.ports", "the server ports",
-                    new VectorParameter<PortParameter>(&ports));
-  options.addOption("--server.int32-value", "an int32 value",
-                    new Int32Parameter(&int32));
-  options.addOption("--server.uint32-value", "a uint32 value",
-                    new UInt32Parameter(&uint32));
-  options.addOption("--server.bounded-value", "a bounded uint32 value",
-                    new BoundedParameter<UInt32Parameter>(&bounded, 42, 8193));
-
-  // "database" options section
-  options.addSection("database", "Database options description goes here");
-  options.addOption("--database.journal-size", "maximal journal size",
-                    new UInt32Parameter(&journalSize));
-  options.addOption("--database.wait-for-sync", "wait for sync description",
-                    new BooleanParameter(&waitForSync));
-
-  // hidden section
-  options.addHiddenSection("debugging",
-                           "Debugging options description goes here");
-  options.addOption("--debugging.crash-me",
-                    "whatever (option can still be used but it is not shown)",
-                    new BooleanParameter(&crashMe));
-  options.addObsoleteOption("--debugging.not-used-anymore",
-                            "whatever (obsolete)");
-
-  // obsolete section (all options in this section do nothing)
-  options.addObsoleteSection("y2kbug");
+  // set up sections and options
+  addExampleOptions(options, values);
 
   // make sections and options definitions immutable
   // any further attempt to add sections or options will throw an exception
@@ -165,10 +87,29 @@ int main(int argc, char* argv[]) {
   // certainty that parameter definitions are not modified after a certain point
   options.seal();
 
+  // parse options from environment variables, e.g. EXAMPLE_SERVER__INT32_VALUE
+  // these are parsed first so that command-line options take precedence
+  {
+    EnvironmentParser parser(&options, "EXAMPLE_");
+    if (!parser.parse()) {
+      // environment parsing failed. an error was already printed by now,
+      // so we can exit
+      return 0;
+    }
+  }
 
   // parse initial command-line options from argv
   {
     ArgumentParser parser(&options);
+    // allow reading arguments from response files, e.g. "@args.txt"
+    parser.allowResponseFiles(true);
+
+    std::string helpSearch = parser.helpSearch(argc, argv);
+    if (!helpSearch.empty()) {
+      // user asked for "--help-search <terms>"
+      options.printSearchHelp(helpSearch);
+      return 0;
+    }
 
     std::string helpSection = parser.helpSection(argc, argv);
     if (!helpSection.empty()) {
@@ -191,19 +132,29 @@ int main(int argc, char* argv[]) {
     }
   }
 
-  if (!configFile.empty()) {
+  if (!values.configFile.empty()) {
     // config file specified, now parse it
-    std::cout << "Parsing config file '" << configFile << "'..." << std::endl
-              << std::endl;
+    std::cout << "Parsing config file '" << values.configFile << "'..."
+              << std::endl << std::endl;
 
     IniFileParser parser(&options);
-    if (!parser.parse(configFile)) {
+    // "-" means reading the configuration from stdin, e.g. from a pipe
+    bool const ok = (values.configFile == "-")
+                        ? parser.parse(std::cin, "stdin")
+                        : parser.parse(values.configFile);
+    if (!ok) {
       // config file parsing failed. an error was already printed
       // by now, so we can exit
       return 0;
     }
   }
 
+  if (!options.checkConstraints()) {
+    // a constraint is violated. an error was already printed by now,
+    // so we can exit
+    return 0;
+  }
+
   // all setup is done. now print some options
   std::cout << "Options parsed successfully" << std::endl << std::endl;
 
@@ -0,0 +1,123 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+
+#include "HotValue.h"
+#include "Parameters.h"
+#include "ProgramOptions.h"
+#include "ThreadPool.h"
+
+using namespace arangodb::options;
+
+// compares the read throughput of a HotValue with a single shared atomic
+// usage: hot_value_bench [<threads> [<milliseconds>]]
+// all threads read the value in a loop, while one more thread updates it
+// every 100 microseconds: the HotValue via ProgramOptions::setValue(), the
+// atomic via a store. the hot value has one replica per reader thread
+
+namespace {
+
+// sum of all values read, so that the reads are not optimized away
+std::atomic<uint64_t> sink(0);
+
+// run the readers for the given time while the writer updates the value.
+// returns the total number of reads per second
+template <typename Read, typename Write>
+double run(size_t threads, std::chrono::milliseconds duration,
+           Read const& read, Write const& write) {
+  std::atomic<bool> stop(false);
+  std::vector<uint64_t> reads(threads, 0);
+  std::vector<std::thread> readers;
+
+  for (size_t i = 0; i < threads; ++i) {
+    readers.emplace_back([&stop, &reads, &read, i]() {
+      uint64_t count = 0;
+      uint64_t sum = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        for (size_t j = 0; j < 1024; ++j) {
+          sum += read();
+        }
+        count += 1024;
+      }
+      reads[i] = count;
+      sink.fetch_add(sum);
+    });
+  }
+
+  std::thread writer([&stop, &write]() {
+    uint64_t value = 1;
+    while (!stop.load(std::memory_order_relaxed)) {
+      write(value++);
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+  });
+
+  auto const start = std::chrono::steady_clock::now();
+  std::this_thread::sleep_for(duration);
+  stop.store(true);
+  for (auto& it : readers) {
+    it.join();
+  }
+  writer.join();
+  double const seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+
+  uint64_t total = 0;
+  for (size_t i = 0; i < threads; ++i) {
+    total += reads[i];
+  }
+  return total / seconds;
+}
+}
+
+int main(int argc, char* argv[]) {
+  size_t threads = ThreadPool::defaultConcurrency();
+  std::chrono::milliseconds duration(1000);
+  if (argc > 1) {
+    threads = static_cast<size_t>(std::strtoul(argv[1], nullptr, 10));
+  }
+  if (argc > 2) {
+    duration = std::chrono::milliseconds(std::strtoul(argv[2], nullptr, 10));
+  }
+
+  // a single shared atomic
+  std::atomic<uint64_t> shared(0);
+  double const sharedReads = run(
+      threads, duration,
+      [&shared]() { return shared.load(std::memory_order_acquire); },
+      [&shared](uint64_t value) {
+        shared.store(value, std::memory_order_release);
+      });
+
+  // a hot value, updated via the options
+  ProgramOptions options("hot_value_bench", "", "",
+                         []() { return size_t(80); }, nullptr);
+  uint64_t batchSize = 0;
+  options.addSection("server", "");
+  options.addOption("--server.batch-size", "",
+                    new UInt64Parameter(&batchSize));
+  options.seal();
+  HotValue<uint64_t> hot(&options, "server.batch-size", &batchSize, threads);
+  std::string buffer;
+  double const hotReads = run(
+      threads, duration, [&hot]() { return hot.get(); },
+      [&options, &buffer](uint64_t value) {
+        buffer = std::to_string(value);
+        options.setValue("server.batch-size", buffer);
+      });
+
+  std::cout << threads << " reader threads, " << hot.replicas()
+            << " replicas" << std::endl;
+  std::cout << "shared atomic: " << sharedReads / 1e6 << " M reads/s"
+            << std::endl;
+  std::cout << "hot value:     " << hotReads / 1e6 << " M reads/s ("
+            << hotReads / sharedReads << "x)" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,195 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <cstdint>
+
+#include "ConfigWriter.h"
+#include "Parameters.h"
+#include "ProgramOptions.h"
+#include "StaticSchema.h"
+
+using namespace arangodb::options;
+
+// checks that the variants of built-in parameters follow changes of the
+// parameters' ptr fields made after the options were added, and that
+// static options and derived parameter types keep working
+// usage: parameter_variant_test
+// the exit code is 1 if any check fails
+
+namespace {
+
+size_t failures = 0;
+
+void check(bool condition, std::string const& what) {
+  if (!condition) {
+    ++failures;
+    std::cout << "check failed: " << what << std::endl;
+  }
+}
+
+// a type derived from a built-in one, which must not be devirtualized
+struct EvenParameter : public UInt32Parameter {
+  explicit EvenParameter(uint32_t* ptr) : UInt32Parameter(ptr) {}
+
+  std::string check(std::string const& value) const override {
+    std::string result = UInt32Parameter::check(value);
+    if (result.empty() && toNumber<uint32_t>(value) % 2 != 0) {
+      return "value must be even";
+    }
+    return result;
+  }
+
+  std::string set(std::string const& value) override {
+    std::string result = check(value);
+    if (result.empty()) {
+      *ptr = toNumber<uint32_t>(value);
+    }
+    return result;
+  }
+};
+
+// every variable exists twice: the one the option is added with, and the
+// one its parameter is pointed to afterwards
+struct Variables {
+  Variables()
+      : flag(false),
+        boolean(false),
+        int32(0),
+        uint64(0),
+        ratio(0.0),
+        bounded(10),
+        even(0) {}
+
+  bool flag;
+  bool boolean;
+  int32_t int32;
+  uint64_t uint64;
+  double ratio;
+  std::string name;
+  uint16_t bounded;
+  std::vector<int64_t> sizes;
+  std::vector<std::string> names;
+  uint32_t even;
+};
+
+struct Setup {
+  Setup()
+      : options("parameter_variant_test", "", "", []() { return size_t(80); },
+                nullptr) {
+    options.addSection("test", "");
+    auto flagParameter = new BooleanParameter(&added.flag, false);
+    auto booleanParameter = new BooleanParameter(&added.boolean);
+    auto int32Parameter = new Int32Parameter(&added.int32);
+    auto uint64Parameter = new UInt64Parameter(&added.uint64);
+    auto ratioParameter = new DoubleParameter(&added.ratio);
+    auto nameParameter = new StringParameter(&added.name);
+    auto boundedParameter =
+        new BoundedParameter<UInt16Parameter>(&added.bounded, 1, 100);
+    auto sizesParameter = new VectorParameter<Int64Parameter>(&added.sizes);
+    auto namesParameter = new VectorParameter<StringParameter>(&added.names);
+    auto evenParameter = new EvenParameter(&added.even);
+
+    options.addOption("--test.flag", "", flagParameter);
+    options.addOption("--test.boolean", "", booleanParameter);
+    options.addOption("--test.int32", "", int32Parameter);
+    options.addOption("--test.uint64", "", uint64Parameter);
+    options.addOption("--test.ratio", "", ratioParameter);
+    options.addOption("--test.name", "", nameParameter);
+    options.addOption("--test.bounded", "", boundedParameter);
+    options.addOption("--test.sizes", "", sizesParameter);
+    options.addOption("--test.names", "", namesParameter);
+    options.addOption("--test.even", "", evenParameter);
+
+    // point the parameters to other variables after adding them
+    flagParameter->ptr = &moved.flag;
+    booleanParameter->ptr = &moved.boolean;
+    int32Parameter->ptr = &moved.int32;
+    uint64Parameter->ptr = &moved.uint64;
+    ratioParameter->ptr = &moved.ratio;
+    nameParameter->ptr = &moved.name;
+    boundedParameter->ptr = &moved.bounded;
+    sizesParameter->ptr = &moved.sizes;
+    namesParameter->ptr = &moved.names;
+    evenParameter->ptr = &moved.even;
+
+    options.seal();
+  }
+
+  ProgramOptions options;
+  Variables added;
+  Variables moved;
+};
+}
+
+int main() {
+  {
+    Setup setup;
+    ProgramOptions& options = setup.options;
+
+    check(options.setValue("test.flag", ""), "set flag");
+    check(options.setValue("test.boolean", "true"), "set boolean");
+    check(options.setValue("test.int32", "-5"), "set int32");
+    check(options.setValue("test.uint64", "18446744073709551615"),
+          "set uint64");
+    check(options.setValue("test.ratio", "0.25"), "set double");
+    check(options.setValue("test.name", "value"), "set string");
+    check(options.setValue("test.bounded", "42"), "set bounded");
+    check(!options.setValue("test.bounded", "101"), "bounds are checked");
+    check(options.setValue("test.sizes", "1"), "set vector");
+    check(options.setValue("test.sizes", "2"), "append to vector");
+    check(options.setValue("test.names", "a"), "set string vector");
+    check(options.setValue("test.even", "4"), "set derived type");
+    check(!options.setValue("test.even", "5"), "derived type checks value");
+
+    Variables const& moved = setup.moved;
+    check(moved.flag && moved.boolean && moved.int32 == -5 &&
+              moved.uint64 == UINT64_MAX && moved.ratio == 0.25 &&
+              moved.name == "value" && moved.bounded == 42 &&
+              moved.sizes == std::vector<int64_t>({1, 2}) &&
+              moved.names == std::vector<std::string>({"a"}) &&
+              moved.even == 4,
+          "values are stored in the new variables");
+
+    Variables const& added = setup.added;
+    check(!added.flag && !added.boolean && added.int32 == 0 &&
+              added.uint64 == 0 && added.ratio == 0.0 && added.name.empty() &&
+              added.bounded == 10 && added.sizes.empty() &&
+              added.names.empty() && added.even == 0,
+          "the old variables are unchanged");
+
+    // output goes through the variants as well
+    std::string json;
+    ConfigWriter(&options).writeJson(json, false);
+    check(json.find("\"test.int32\": -5") != std::string::npos &&
+              json.find("\"test.sizes\": [1,2]") != std::string::npos &&
+              json.find("\"test.name\": \"value\"") != std::string::npos,
+          "values are written from the new variables");
+
+    check(options.clearValue("test.sizes") && moved.sizes.empty(),
+          "clearing the new vector");
+  }
+
+  // static options refer to their variables directly
+  {
+    static int32_t threads = 4;
+    static std::string name;
+    static constexpr StaticOption schema[] = {
+        {"static.threads", "", &threads}, {"static.name", "", &name}};
+    static StaticSchema<2> staticSchema(schema);
+
+    ProgramOptions options("parameter_variant_test", "", "",
+                           []() { return size_t(80); }, nullptr);
+    options.addStaticSchema(&staticSchema);
+    options.seal();
+    check(options.setValue("static.threads", "8") && threads == 8,
+          "set static option");
+    check(!options.setValue("static.threads", "x") && threads == 8,
+          "static option checks value");
+    check(options.setValue("static.name", "n") && name == "n",
+          "set static string");
+  }
+
+  std::cout << failures << " failures" << std::endl;
+
+  return failures == 0 ? 0 : 1;
+}
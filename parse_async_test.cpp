@@ -0,0 +1,140 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <thread>
+
+#include "IniFileParser.h"
+#include "Parameters.h"
+#include "ProgramOptions.h"
+
+using namespace arangodb::options;
+
+// checks that IniFileParser::parseAsync() yields the same values as parse()
+// and reports errors through the future, and shows how much of the parse
+// latency is hidden behind other startup work
+// usage: parse_async_test
+// the exit code is 1 if any check fails
+
+namespace {
+
+size_t const Sections = 10;
+size_t const OptionsPerSection = 100;
+size_t const Lines = 400000;
+
+size_t failures = 0;
+
+void check(bool condition, std::string const& what) {
+  if (!condition) {
+    ++failures;
+    std::cout << "check failed: " << what << std::endl;
+  }
+}
+
+std::string optionName(size_t i) {
+  return "section" + std::to_string(i / OptionsPerSection) + ".option" +
+         std::to_string(i % OptionsPerSection);
+}
+
+// options plus their destination variables
+struct Setup {
+  Setup()
+      : options("parse_async_test", "", "", []() { return size_t(80); },
+                nullptr),
+        values(Sections * OptionsPerSection, 0) {
+    for (size_t i = 0; i < Sections; ++i) {
+      options.addSection("section" + std::to_string(i), "");
+    }
+    for (size_t i = 0; i < values.size(); ++i) {
+      options.addOption("--" + optionName(i), "",
+                        new UInt64Parameter(&values[i]));
+    }
+    options.seal();
+  }
+
+  ProgramOptions options;
+  std::vector<uint64_t> values;
+};
+
+void writeConfig(std::string const& filename) {
+  std::ofstream out(filename);
+  for (size_t i = 0; i < Lines; ++i) {
+    size_t const option = i % (Sections * OptionsPerSection);
+    out << optionName(option) << " = " << i << "\n";
+  }
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+// other startup work that does not touch the options, e.g. opening
+// listening sockets or loading data files
+void simulateWork(double seconds) {
+  std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+}
+}
+
+int main() {
+  std::string const filename = "parse_async_test.ini";
+  writeConfig(filename);
+
+  // sequential startup: parse, then the other work
+  Setup sequential;
+  auto start = std::chrono::steady_clock::now();
+  IniFileParser sequentialParser(&sequential.options);
+  check(sequentialParser.parse(filename), "sequential parse");
+  double const parseTime = secondsSince(start);
+  simulateWork(parseTime);
+  double const sequentialTime = secondsSince(start);
+
+  // overlapped startup: start parsing, do the other work, then wait
+  Setup overlapped;
+  start = std::chrono::steady_clock::now();
+  IniFileParser overlappedParser(&overlapped.options);
+  std::future<bool> result = overlappedParser.parseAsync(filename);
+  simulateWork(parseTime);
+  check(result.get(), "asynchronous parse");
+  double const overlappedTime = secondsSince(start);
+
+  check(sequential.values == overlapped.values, "values");
+  check(overlapped.values[0] == Lines - Sections * OptionsPerSection,
+        "last value wins");
+
+  // errors are reported through the future
+  {
+    Setup setup;
+    IniFileParser parser(&setup.options);
+    check(!parser.parseAsync("parse_async_test.missing").get(),
+          "missing file fails");
+  }
+  {
+    std::ofstream("parse_async_test.invalid") << "no.such-option = 1\n";
+    Setup setup;
+    IniFileParser parser(&setup.options);
+    check(!parser.parseAsync("parse_async_test.invalid").get(),
+          "unknown option fails");
+    check(setup.options.processingResult().failed(), "failure recorded");
+    std::remove("parse_async_test.invalid");
+  }
+
+  std::remove(filename.c_str());
+
+  double const hidden = sequentialTime - overlappedTime;
+  check(hidden > 0, "latency hidden");
+
+  std::cout << "parse " << parseTime * 1000 << " ms, sequential startup "
+            << sequentialTime * 1000 << " ms, overlapped startup "
+            << overlappedTime * 1000 << " ms, " << hidden * 1000
+            << " ms hidden" << std::endl;
+  std::cout << failures << " failures" << std::endl;
+
+  return failures == 0 ? 0 : 1;
+}
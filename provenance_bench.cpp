@@ -0,0 +1,106 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+
+#include "Parameters.h"
+#include "ProgramOptions.h"
+
+using namespace arangodb::options;
+
+// measures the cost of recording provenance in ProgramOptions::setValue()
+// usage: provenance_bench [<values>]
+// values are set round-robin for 1000 options, once via setValue() and once
+// via the parameters directly, which is what setValue() did before values
+// were recorded. afterwards, every option has the maximal number of layers
+
+namespace {
+
+size_t const Options = 1000;
+
+std::string optionName(size_t i) {
+  return "section" + std::to_string(i / 100) + ".option" +
+         std::to_string(i % 100);
+}
+
+struct Setup {
+  Setup()
+      : options("provenance_bench", "", "", []() { return size_t(80); },
+                nullptr),
+        values(Options, 0) {
+    for (size_t i = 0; i < Options / 100; ++i) {
+      options.addSection("section" + std::to_string(i), "");
+    }
+    for (size_t i = 0; i < Options; ++i) {
+      names.emplace_back(optionName(i));
+      options.addOption("--" + names.back(), "",
+                        new UInt64Parameter(&values[i]));
+    }
+    options.seal();
+    options.setLocation(SourceLocation(SourceType::ConfigFile, "bench.ini", 0));
+  }
+
+  ProgramOptions options;
+  std::vector<uint64_t> values;
+  std::vector<std::string> names;
+};
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+}
+
+int main(int argc, char* argv[]) {
+  size_t count = 10000000;
+  if (argc > 1) {
+    count = static_cast<size_t>(std::strtoul(argv[1], nullptr, 10));
+  }
+
+  std::vector<std::string> values;
+  for (size_t i = 0; i < 1000; ++i) {
+    values.emplace_back(std::to_string(i * 7919));
+  }
+
+  // without recording: look up the option and set the parameter
+  Setup direct;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < count; ++i) {
+    std::string const& name = direct.names[i % Options];
+    Option const* option = direct.options.findOption(name);
+    if (!option->parameter->set(values[i % values.size()]).empty()) {
+      return 1;
+    }
+    direct.options.processingResult().touch(name);
+  }
+  double const directTime = secondsSince(start);
+
+  // with recording
+  Setup recorded;
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < count; ++i) {
+    if (!recorded.options.setValue(recorded.names[i % Options],
+                                   values[i % values.size()])) {
+      return 1;
+    }
+  }
+  double const recordedTime = secondsSince(start);
+
+  size_t const layers = recorded.options.provenance(recorded.names[0])
+                            .layers.size();
+
+  std::cout << "without recording: " << directTime * 1e9 / count
+            << " ns per value" << std::endl;
+  std::cout << "setValue():        " << recordedTime * 1e9 / count
+            << " ns per value" << std::endl;
+  std::cout << "recording cost:    "
+            << (recordedTime - directTime) * 1e9 / count << " ns per value"
+            << std::endl;
+  std::cout << "layers kept per option: " << layers << " (maximum "
+            << ProgramOptions::Provenance::MaxLayers << ")" << std::endl;
+
+  return layers <= ProgramOptions::Provenance::MaxLayers ? 0 : 1;
+}
@@ -0,0 +1,134 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+
+#include "HotValue.h"
+#include "Parameters.h"
+#include "ProgramOptions.h"
+#include "ReadProfiler.h"
+
+using namespace arangodb::options;
+
+// measures the overhead of a ReadProfiler on option reads
+// usage: read_profiler_bench [<reads>]
+// 100 options are read round-robin via ProgramOptions::get() and via
+// HotValue::get(), each from 10 call sites: without a profiler, with a
+// disabled profiler, with a profiler sampling one out of 64 reads, and with
+// a profiler recording every read
+
+namespace {
+
+size_t const Options = 100;
+
+// sum of all values read, so that the reads are not optimized away
+uint64_t sink = 0;
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+struct Setup {
+  explicit Setup(ReadProfiler* profiler)
+      : options("read_profiler_bench", "", "", []() { return size_t(80); },
+                nullptr),
+        values(Options, 0) {
+    options.addSection("server", "");
+    for (size_t i = 0; i < Options; ++i) {
+      names.emplace_back("server.option" + std::to_string(i));
+      values[i] = i;
+      options.addOption("--" + names.back(), "",
+                        new UInt64Parameter(&values[i]));
+    }
+    options.seal();
+    options.setReadProfiler(profiler);
+    // hot values pick up the profiler when they are created
+    for (size_t i = 0; i < Options; ++i) {
+      hot.emplace_back(
+          new HotValue<uint64_t>(&options, names[i], &values[i], 1));
+    }
+  }
+
+  ProgramOptions options;
+  std::vector<uint64_t> values;
+  std::vector<std::string> names;
+  std::vector<std::unique_ptr<HotValue<uint64_t>>> hot;
+};
+
+// read the options via ProgramOptions::get(), from 10 call sites.
+// returns the time per read in nanoseconds
+double readOptions(Setup& setup, size_t count) {
+  auto const start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < count; i += 10) {
+    std::string const& name = setup.names[(i / 10) % Options];
+#define READ sink += *setup.options.get<UInt64Parameter>(name, \
+                      ARANGODB_PROGRAM_OPTIONS_READ_SITE)->ptr
+    READ; READ; READ; READ; READ; READ; READ; READ; READ; READ;
+#undef READ
+  }
+  return secondsSince(start) * 1e9 / count;
+}
+
+// read the hot values, from 10 call sites. returns the time per read in
+// nanoseconds
+double readHotValues(Setup& setup, size_t count) {
+  auto const start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < count; i += 10) {
+    HotValue<uint64_t> const& hot = *setup.hot[(i / 10) % Options];
+#define READ sink += hot.get(ARANGODB_PROGRAM_OPTIONS_READ_SITE)
+    READ; READ; READ; READ; READ; READ; READ; READ; READ; READ;
+#undef READ
+  }
+  return secondsSince(start) * 1e9 / count;
+}
+
+// run both kinds of reads with a profiler. returns the number of reads
+// the profiler has recorded. the report must be built while the options
+// exist
+uint64_t run(std::string const& label, ReadProfiler* profiler, size_t count) {
+  Setup setup(profiler);
+  double const options = readOptions(setup, count);
+  double const hot = readHotValues(setup, count);
+  std::cout << label << options << " ns per get(), " << hot
+            << " ns per HotValue::get()" << std::endl;
+
+  uint64_t recorded = 0;
+  if (profiler != nullptr) {
+    for (auto const& it : profiler->report()) {
+      recorded += it.count;
+    }
+  }
+  return recorded;
+}
+}
+
+int main(int argc, char* argv[]) {
+  size_t count = 10000000;
+  if (argc > 1) {
+    count = static_cast<size_t>(std::strtoul(argv[1], nullptr, 10));
+  }
+  // each loop iteration reads from all 10 call sites
+  count = (count + 9) / 10 * 10;
+
+  run("no profiler:       ", nullptr, count);
+
+  ReadProfiler disabled;
+  disabled.enabled(false);
+  run("disabled profiler: ", &disabled, count);
+
+  ReadProfiler sampling(64);
+  run("sampling 1/64:     ", &sampling, count);
+
+  // both the option reads and the hot value reads are recorded
+  ReadProfiler full;
+  uint64_t const recorded = run("every read:        ", &full, count);
+  std::cout << "recorded reads: " << recorded << " of " << 2 * count
+            << " (checksum " << sink << ")" << std::endl;
+
+  return recorded == 2 * count ? 0 : 1;
+}
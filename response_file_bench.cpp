@@ -0,0 +1,134 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "ArgumentParser.h"
+#include "Parameters.h"
+#include "ProgramOptions.h"
+#include "Token.h"
+
+using namespace arangodb::options;
+
+// measures the expansion of large response files
+// usage: response_file_bench [<tokens>]
+// a response file with the given number of tokens (one million by default)
+// is generated: options with numeric and quoted string values, plus quoted
+// positional arguments. it is then tokenized, and parsed with a positional
+// handler
+
+namespace {
+
+size_t const Options = 100;
+
+struct Setup {
+  Setup()
+      : options("response_file_bench", "", "", []() { return size_t(80); },
+                nullptr),
+        numbers(Options, 0),
+        positionals(0) {
+    options.addSection("bench", "");
+    for (size_t i = 0; i < Options; ++i) {
+      options.addOption("--bench.number" + std::to_string(i), "",
+                        new UInt64Parameter(&numbers[i]));
+    }
+    options.addOption("--bench.string", "", new StringParameter(&string));
+    options.seal();
+    options.setPositionalHandler([this](std::string const&) {
+      ++positionals;
+      return std::string();
+    });
+  }
+
+  ProgramOptions options;
+  std::vector<uint64_t> numbers;
+  std::string string;
+  size_t positionals;
+};
+
+// write a response file with the given number of tokens. returns the size
+// of the file
+size_t writeResponseFile(std::string const& filename, size_t tokens) {
+  std::ofstream out(filename);
+  for (size_t i = 0; i < tokens; ++i) {
+    switch (i % 4) {
+      case 0:
+        out << "--bench.number" << (i % Options) << " " << i << "\n";
+        break;
+      case 1:
+        out << "--bench.string \"a quoted value " << i << "\"\n";
+        break;
+      case 2:
+        out << "--bench.number" << (i % Options) << "=" << i << "\n";
+        break;
+      default:
+        out << "'/data/positional " << i << ".dat'\n";
+        break;
+    }
+  }
+  return static_cast<size_t>(out.tellp());
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+}
+
+int main(int argc, char* argv[]) {
+  size_t count = 1000000;
+  if (argc > 1) {
+    count = static_cast<size_t>(std::strtoul(argv[1], nullptr, 10));
+  }
+
+  std::string const filename = "response_file_bench.txt";
+  size_t const bytes = writeResponseFile(filename, count);
+
+  std::string program("response_file_bench");
+  std::string file("@" + filename);
+  char* args[] = {&program[0], &file[0]};
+
+  // tokenize only
+  Setup tokenized;
+  ArgumentParser tokenizedParser(&tokenized.options);
+  tokenizedParser.allowResponseFiles(true);
+  size_t tokens = 0;
+  bool ok = true;
+  auto start = std::chrono::steady_clock::now();
+  ArgumentParser::Tokenizer tokenizer = tokenizedParser.tokenize(2, args);
+  Token token;
+  while (tokenizer.next(token)) {
+    ok &= token.type == Token::Type::Option ||
+          token.type == Token::Type::Positional;
+    ++tokens;
+  }
+  double const tokenizeTime = secondsSince(start);
+
+  // tokenize and apply
+  Setup parsed;
+  ArgumentParser parser(&parsed.options);
+  parser.allowResponseFiles(true);
+  start = std::chrono::steady_clock::now();
+  ok &= parser.parse(2, args);
+  double const parseTime = secondsSince(start);
+
+  std::remove(filename.c_str());
+
+  ok &= tokens == count && parsed.positionals == count / 4;
+
+  std::cout << tokens << " tokens, " << bytes << " bytes, "
+            << parsed.positionals << " positionals" << std::endl;
+  std::cout << "tokenize: " << tokenizeTime * 1000 << " ms, "
+            << tokens / tokenizeTime / 1e6 << " M tokens/s, "
+            << bytes / tokenizeTime / 1e6 << " MB/s" << std::endl;
+  std::cout << "parse:    " << parseTime * 1000 << " ms, "
+            << tokens / parseTime / 1e6 << " M tokens/s, "
+            << bytes / parseTime / 1e6 << " MB/s" << std::endl;
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <utility>
+
+#include "IniScanner.h"
+
+using namespace arangodb::options;
+
+// measures the throughput of the scanner kernels on a synthetic config
+// usage: scanner_bench [<megabytes>]
+// the config consists of sections, comments and assignments with values of
+// varying length. every kernel scans it several times, and the best run is
+// reported in GB/s
+
+namespace {
+
+std::string syntheticConfig(size_t size) {
+  std::string result;
+  result.reserve(size + 128);
+
+  size_t section = 0;
+  size_t option = 0;
+  while (result.size() < size) {
+    if (option % 64 == 0) {
+      result.append("\n[section-" + std::to_string(section++) + "]\n");
+      result.append("# options of the section\n");
+    }
+    result.append("option-" + std::to_string(option) + " = ");
+    result.append(option % 7, 'v');
+    result.append(std::to_string(option * 2654435761u % 100000));
+    result.append(option % 13 == 0 ? "\r\n" : "\n");
+    ++option;
+  }
+  return result;
+}
+
+std::vector<std::pair<std::string, IniScanner::KernelType>> kernels() {
+  std::vector<std::pair<std::string, IniScanner::KernelType>> result;
+  result.emplace_back("scalar", &IniScanner::scanBlockScalar);
+#ifdef ARANGODB_PROGRAM_OPTIONS_SCANNER_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2")) {
+    result.emplace_back("sse2", &IniScanner::scanBlockSSE2);
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    result.emplace_back("avx2", &IniScanner::scanBlockAVX2);
+  }
+#endif
+  return result;
+}
+}
+
+int main(int argc, char* argv[]) {
+  size_t megabytes = 256;
+  if (argc > 1) {
+    megabytes = static_cast<size_t>(std::strtoul(argv[1], nullptr, 10));
+  }
+
+  std::string const input = syntheticConfig(megabytes * 1024 * 1024);
+  size_t const runs = 5;
+
+  for (auto const& kernel : kernels()) {
+    double best = 0.0;
+    size_t lines = 0;
+
+    for (size_t run = 0; run < runs; ++run) {
+      lines = 0;
+      auto const start = std::chrono::steady_clock::now();
+      IniScanner::scan(kernel.second, input.data(), input.size(),
+                       [&lines](IniLine const&) {
+                         ++lines;
+                         return true;
+                       });
+      double const seconds = std::chrono::duration<double>(
+                                 std::chrono::steady_clock::now() - start)
+                                 .count();
+      double const throughput = input.size() / seconds / 1e9;
+      if (throughput > best) {
+        best = throughput;
+      }
+    }
+
+    std::cout << kernel.first << ": " << best << " GB/s (" << input.size()
+              << " bytes, " << lines << " lines)" << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,170 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <random>
+#include <utility>
+
+#include "IniScanner.h"
+
+using namespace arangodb::options;
+
+// checks that all scanner kernels available on this CPU produce the same
+// block masks and lines as the scalar kernel
+// usage: scanner_test
+// the exit code is 1 if any kernel differs from the scalar kernel
+
+namespace {
+
+size_t failures = 0;
+
+void check(bool condition, std::string const& kernel,
+           std::string const& what, std::string const& input) {
+  if (!condition) {
+    ++failures;
+    std::cout << kernel << ": " << what << " differs for input of length "
+              << input.size() << std::endl;
+  }
+}
+
+// the kernels to compare against the scalar kernel
+std::vector<std::pair<std::string, IniScanner::KernelType>> kernels() {
+  std::vector<std::pair<std::string, IniScanner::KernelType>> result;
+#ifdef ARANGODB_PROGRAM_OPTIONS_SCANNER_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2")) {
+    result.emplace_back("sse2", &IniScanner::scanBlockSSE2);
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    result.emplace_back("avx2", &IniScanner::scanBlockAVX2);
+  }
+#endif
+  return result;
+}
+
+// all lines found in the input, plus the offset returned by the scan
+struct ScanResult {
+  std::vector<IniLine> lines;
+  size_t rest;
+};
+
+ScanResult scanAll(IniScanner::KernelType kernel, std::string const& input) {
+  ScanResult result;
+  result.rest = IniScanner::scan(kernel, input.data(), input.size(),
+                                 [&result](IniLine const& line) {
+                                   result.lines.emplace_back(line);
+                                   return true;
+                                 });
+  return result;
+}
+
+bool equal(ScanResult const& lhs, ScanResult const& rhs) {
+  if (lhs.rest != rhs.rest || lhs.lines.size() != rhs.lines.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < lhs.lines.size(); ++i) {
+    IniLine const& l = lhs.lines[i];
+    IniLine const& r = rhs.lines[i];
+    if (l.begin != r.begin || l.end != r.end || l.equals != r.equals ||
+        l.carriageReturn != r.carriageReturn) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// compare a kernel with the scalar kernel, for every block of the input and
+// for the complete scan
+void compare(std::string const& name, IniScanner::KernelType kernel,
+             std::string const& input) {
+  for (size_t offset = 0; offset + IniScanner::BlockSize <= input.size();
+       offset += IniScanner::BlockSize) {
+    IniScanMasks expected;
+    IniScanMasks actual;
+    IniScanner::scanBlockScalar(input.data() + offset, expected);
+    kernel(input.data() + offset, actual);
+    check(expected.newlines == actual.newlines &&
+              expected.equals == actual.equals &&
+              expected.returns == actual.returns,
+          name, "block masks", input);
+  }
+
+  check(equal(scanAll(&IniScanner::scanBlockScalar, input),
+              scanAll(kernel, input)),
+        name, "scan result", input);
+}
+
+// inputs covering the block boundaries
+std::vector<std::string> edgeCases() {
+  std::vector<std::string> result;
+
+  for (size_t length : {0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 128,
+                        129}) {
+    result.emplace_back(length, 'a');
+    result.emplace_back(length, '\n');
+    result.emplace_back(length, '=');
+    result.emplace_back(length, '\r');
+
+    // a single delimiter at each position
+    for (size_t i = 0; i < length; ++i) {
+      for (char c : {'\n', '=', '\r'}) {
+        std::string input(length, 'x');
+        input[i] = c;
+        result.emplace_back(input);
+      }
+    }
+  }
+
+  // newlines right in front of, at and behind the block boundaries, with an
+  // '=' in the line spanning the boundary
+  for (size_t boundary : {64, 128, 192}) {
+    for (size_t distance : {0, 1, 2}) {
+      std::string input(boundary + 65, 'k');
+      input[boundary - 1 - distance] = '\n';
+      input[boundary + distance] = '\n';
+      input[boundary - 1 - distance + 1] = '=';
+      result.emplace_back(input);
+    }
+  }
+
+  // bytes with the high bit set must not match anything
+  result.emplace_back(std::string(130, '\x8a'));
+  result.emplace_back(std::string(130, '\xbd'));
+
+  return result;
+}
+
+// random inputs, mostly made of delimiters so that all mask bits are hit
+std::vector<std::string> randomInputs(size_t count) {
+  std::mt19937 random(42);
+  char const alphabet[] = {'\n', '=', '\r', 'a', ' ', '[', ']', '#', ';',
+                           '\0', '\x80', '\xff'};
+  std::vector<std::string> result;
+
+  for (size_t i = 0; i < count; ++i) {
+    std::string input(random() % 1024, ' ');
+    for (auto& c : input) {
+      c = alphabet[random() % sizeof(alphabet)];
+    }
+    result.emplace_back(input);
+  }
+  return result;
+}
+}
+
+int main() {
+  auto const available = kernels();
+  auto inputs = edgeCases();
+  auto const random = randomInputs(10000);
+  inputs.insert(inputs.end(), random.begin(), random.end());
+
+  for (auto const& kernel : available) {
+    for (auto const& input : inputs) {
+      compare(kernel.first, kernel.second, input);
+    }
+  }
+
+  std::cout << available.size() << " kernels, " << inputs.size()
+            << " inputs, " << failures << " failures" << std::endl;
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,230 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "Parameters.h"
+#include "ProgramOptions.h"
+#include "SharedConfig.h"
+
+using namespace arangodb::options;
+
+// checks that forked children read the values of an exported configuration
+// unchanged via the typed accessors, without parsing them
+// usage: shared_config_test [<children>]
+// the exit code is 1 if any check fails
+
+namespace {
+
+size_t failures = 0;
+
+void check(bool condition, std::string const& what) {
+  if (!condition) {
+    ++failures;
+    std::cout << "check failed: " << what << std::endl;
+  }
+}
+
+// a custom parameter type, only exported as text
+struct PathParameter : public Parameter {
+  explicit PathParameter(std::string* ptr) : ptr(ptr) {}
+
+  std::string name() const override { return "path"; }
+  std::string valueString() const override { return stringifyValue(*ptr); }
+  std::string set(std::string const& value) override {
+    *ptr = value;
+    return "";
+  }
+
+  std::string* ptr;
+};
+
+// options of all built-in types
+struct Values {
+  Values()
+      : flag(false),
+        verbose(true),
+        boolean(true),
+        int16(-12345),
+        uint16(65535),
+        int32(-2000000000),
+        uint32(4000000000U),
+        int64(-9000000000000000000LL),
+        uint64(18000000000000000000ULL),
+        ratio(0.30000000000000004),
+        name("with \"quotes\" and = sign"),
+        path("/var/lib/data"),
+        ports({8529, 8530, 65535}),
+        endpoints({"tcp://[::1]:8529", "", "unix:///tmp/socket"}) {}
+
+  bool flag;
+  bool verbose;
+  bool boolean;
+  int16_t int16;
+  uint16_t uint16;
+  int32_t int32;
+  uint32_t uint32;
+  int64_t int64;
+  uint64_t uint64;
+  double ratio;
+  std::string name;
+  std::string path;
+  std::vector<uint16_t> ports;
+  std::vector<std::string> endpoints;
+};
+
+void addOptions(ProgramOptions& options, Values& values) {
+  options.addSection("test", "");
+  options.addOption("--test.flag", "", new BooleanParameter(&values.flag));
+  options.addOption("--test.verbose", "",
+                    new BooleanParameter(&values.verbose));
+  options.addOption("--test.boolean", "",
+                    new BooleanParameter(&values.boolean, true));
+  options.addOption("--test.int16", "", new Int16Parameter(&values.int16));
+  options.addOption("--test.uint16", "", new UInt16Parameter(&values.uint16));
+  options.addOption("--test.int32", "", new Int32Parameter(&values.int32));
+  options.addOption("--test.uint32", "", new UInt32Parameter(&values.uint32));
+  options.addOption("--test.int64", "", new Int64Parameter(&values.int64));
+  options.addOption("--test.uint64", "", new UInt64Parameter(&values.uint64));
+  options.addOption("--test.ratio", "", new DoubleParameter(&values.ratio));
+  options.addOption("--test.name", "", new StringParameter(&values.name));
+  options.addOption("--test.path", "", new PathParameter(&values.path));
+  options.addOption("--test.ports", "",
+                    new VectorParameter<UInt16Parameter>(&values.ports));
+  options.addOption("--test.endpoints", "",
+                    new VectorParameter<StringParameter>(&values.endpoints));
+}
+
+// read all values from the segment and compare them with the expected
+// values. returns the number of mismatches
+template <typename T>
+size_t compare(SharedConfig const& config, std::string const& name,
+               T const& expected, size_t index = 0) {
+  T value;
+  if (!config.get(name, value, index) || !(value == expected)) {
+    std::cout << "value mismatch: " << name << "[" << index << "]"
+              << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+size_t compareAll(SharedConfig const& config, Values const& expected) {
+  size_t mismatches = 0;
+  mismatches += compare(config, "test.flag", expected.flag);
+  mismatches += compare(config, "test.verbose", expected.verbose);
+  mismatches += compare(config, "test.boolean", expected.boolean);
+  mismatches += compare(config, "test.int16", expected.int16);
+  mismatches += compare(config, "test.uint16", expected.uint16);
+  mismatches += compare(config, "test.int32", expected.int32);
+  mismatches += compare(config, "test.uint32", expected.uint32);
+  mismatches += compare(config, "test.int64", expected.int64);
+  mismatches += compare(config, "test.uint64", expected.uint64);
+  mismatches += compare(config, "test.ratio", expected.ratio);
+  mismatches += compare(config, "test.name", expected.name);
+  if (config.value("test.path") != expected.path) {
+    std::cout << "value mismatch: test.path" << std::endl;
+    ++mismatches;
+  }
+  if (config.valueCount("test.ports") != expected.ports.size() ||
+      config.valueCount("test.endpoints") != expected.endpoints.size()) {
+    std::cout << "value count mismatch" << std::endl;
+    ++mismatches;
+  }
+  for (size_t i = 0; i < expected.ports.size(); ++i) {
+    mismatches += compare(config, "test.ports", expected.ports[i], i);
+  }
+  for (size_t i = 0; i < expected.endpoints.size(); ++i) {
+    mismatches += compare(config, "test.endpoints", expected.endpoints[i], i);
+  }
+  return mismatches;
+}
+}
+
+int main(int argc, char* argv[]) {
+#ifndef _WIN32
+  size_t children = 8;
+  if (argc > 1) {
+    children = static_cast<size_t>(std::strtoul(argv[1], nullptr, 10));
+  }
+
+  ProgramOptions options("shared_config_test", "", "",
+                         []() { return size_t(80); }, nullptr);
+  Values values;
+  addOptions(options, values);
+  options.seal();
+  check(options.setValue("test.boolean", "off"), "set boolean");
+  check(options.setValue("test.ratio", "-1.5e-300"), "set double");
+  check(options.setValue("test.name", "changed = value"), "set string");
+
+  // the values as seen by the exporting process
+  Values const expected = values;
+
+  SharedConfig config;
+  check(config.create(&options), "create segment");
+  check(compareAll(config, expected) == 0, "values in parent");
+
+  // typed reads check the type and the range of the target
+  {
+    int8_t small;
+    uint16_t unsignedValue;
+    double number;
+    std::string text;
+    bool flag;
+    check(!config.get("test.int16", small), "int16 does not fit into int8");
+    check(!config.get("test.int16", unsignedValue),
+          "negative value does not fit into unsigned");
+    check(!config.get("test.int32", number), "integer is not a double");
+    check(!config.get("test.path", text), "custom type is text only");
+    check(!config.get("test.flag", flag, 1), "flag has a single value");
+    check(!config.get("test.ports", unsignedValue, 3), "index out of range");
+    check(!config.get("test.unknown", flag), "unknown option");
+  }
+
+  // change the values in the parent after exporting. the children must
+  // still see the exported values
+  values.int64 = 0;
+  values.name = "changed after export";
+  values.ports.clear();
+
+  // children inherit the descriptor. attach via a duplicate of it, as an
+  // exec'd worker would, and read the values without parsing them
+  std::vector<pid_t> pids;
+  for (size_t i = 0; i < children; ++i) {
+    pid_t pid = ::fork();
+    if (pid == 0) {
+      SharedConfig child;
+      if (!child.attach(::dup(config.fd()))) {
+        std::cout << "child cannot attach" << std::endl;
+        ::_exit(1);
+      }
+      ::_exit(compareAll(child, expected) == 0 ? 0 : 1);
+    }
+    check(pid > 0, "fork");
+    if (pid > 0) {
+      pids.push_back(pid);
+    }
+  }
+
+  for (pid_t pid : pids) {
+    int status = 0;
+    check(::waitpid(pid, &status, 0) == pid && WIFEXITED(status) &&
+              WEXITSTATUS(status) == 0,
+          "child " + std::to_string(pid) + " reads values unchanged");
+  }
+#else
+  (void)argc;
+  (void)argv;
+  std::cout << "shared configurations are not supported" << std::endl;
+#endif
+
+  std::cout << failures << " failures" << std::endl;
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+
+#include "ConfigValidator.h"
+#include "ExampleOptions.h"
+#include "ProgramOptions.h"
+#include "ThreadPool.h"
+
+using namespace arangodb::options;
+
+// validates config files against the options of the example program
+// usage: validate [--threads <n>] <file>...
+// the options are registered once, and all files are validated in parallel
+// without setting any option values. errors are printed one per line as
+// "<file>:<line>: <option>: <message>", followed by a summary. the exit code
+// is 1 if any file is invalid
+int main(int argc, char* argv[]) {
+  size_t concurrency = ThreadPool::defaultConcurrency();
+  std::vector<std::string> files;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string const current(argv[i]);
+    if (current == "--threads" && i + 1 < argc) {
+      concurrency = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+    } else {
+      files.emplace_back(current);
+    }
+  }
+
+  if (files.empty()) {
+    std::cerr << "usage: " << argv[0] << " [--threads <n>] <file>..."
+              << std::endl;
+    return 2;
+  }
+
+  // register the schema once. the values are never written to
+  ExampleOptions values;
+  ProgramOptions options(argv[0], "", "", []() { return size_t(80); },
+                         nullptr);
+  addExampleOptions(options, values);
+  options.seal();
+
+  ConfigValidator validator(&options);
+
+  auto const start = std::chrono::steady_clock::now();
+  auto const results = validator.validate(files, concurrency);
+  double const seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+
+  size_t invalid = 0;
+  for (auto const& result : results) {
+    if (result.ok()) {
+      continue;
+    }
+    ++invalid;
+    for (auto const& error : result.errors) {
+      std::cout << error.file << ":" << error.line << ": ";
+      if (!error.option.empty()) {
+        std::cout << error.option << ": ";
+      }
+      std::cout << error.message << std::endl;
+    }
+  }
+
+  std::cout << results.size() << " files, " << invalid << " invalid, "
+            << static_cast<uint64_t>(results.size() /
+                                     (seconds > 0 ? seconds : 1e-9))
+            << " files/s" << std::endl;
+
+  return invalid == 0 ? 0 : 1;
+}